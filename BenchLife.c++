@@ -0,0 +1,372 @@
+// ---------------------------
+// projects/life/BenchLife.c++
+// ---------------------------
+
+/*
+  To run the benchmark:
+  % g++ -ansi -pedantic -Wall -pthread -O2 BenchLife.c++ -o BenchLife.app
+  % BenchLife.app [-o results.csv] [size ...]
+
+  Each size is the side of a square board; the default sizes are 20, 128,
+  512 and 1024.  Larger boards, up to 16384, can be given on the command
+  line.  Results are printed and also written as CSV to BenchLife.csv, or
+  to the file given with -o, one line per engine, board and size.  Last,
+  1024 boards of 64x64 are run one at a time and then as one BatchLife.
+  Every run is made in a child process of its own, so the peak RSS
+  reported is that of the run alone.
+*/
+
+// --------
+// includes
+// --------
+
+#include <cstdio>    // perror
+#include <cstdlib>   // atoi, exit, malloc, free, rand, srand
+#include <cstring>   // strcmp
+#include <fstream>   // ofstream
+#include <iomanip>   // setw
+#include <iostream>  // cout, endl
+#include <new>       // bad_alloc
+#include <sstream>   // istringstream
+#include <string>    // string
+#include <vector>    // vector
+
+#include <sys/resource.h> // rusage
+#include <sys/time.h>     // gettimeofday
+#include <sys/wait.h>     // wait4
+#include <unistd.h>       // fork, pipe, read, write, _exit
+
+#include "Life.h"
+
+// -----------
+// allocations
+// -----------
+
+static long allocations = 0;
+
+void* operator new(size_t size) throw(std::bad_alloc) {
+  ++allocations;
+  void* p = malloc(size ? size : 1);
+  if(!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) throw() {
+  free(p);
+}
+
+// ------
+// boards
+// ------
+
+typedef char (*CellChar)(bool alive);
+
+/**
+ * Get the char for a Conway cell
+ * @param alive whether the cell is alive
+ * @return char '*' or '.'.
+ */
+char conwayChar(bool alive) {
+  return alive ? '*' : '.';
+}
+
+/**
+ * Get the char for an age 0 Fredkin cell
+ * @param alive whether the cell is alive
+ * @return char '0' or '-'.
+ */
+char fredkinChar(bool alive) {
+  return alive ? '0' : '-';
+}
+
+/**
+ * Get the char for a Conway or Fredkin cell, picked at random
+ * @param alive whether the cell is alive
+ * @return char one of "*.0-".
+ */
+char mixedChar(bool alive) {
+  return rand() % 2 ? conwayChar(alive) : fredkinChar(alive);
+}
+
+/**
+ * Build a board with cells alive at random
+ * @param size the number of rows and columns on the board
+ * @param density the fraction of cells that are alive
+ * @param cellChar the char of an alive or dead cell
+ * @return string in the format read by Life(istream&)
+ */
+string randomBoard(int size, double density, CellChar cellChar) {
+  ostringstream out;
+  out << size << '\n' << size << '\n';
+  string row(size + 1, '\n');
+  for(int r = 0; r < size; r++) {
+    for(int c = 0; c < size; c++)
+      row[c] = cellChar(rand() < density * RAND_MAX);
+    out << row;
+  }
+  return out.str();
+}
+
+/**
+ * Build a board of gliders, one in the corner of every 8x8 square
+ * @param size the number of rows and columns on the board
+ * @param cellChar the char of an alive or dead cell
+ * @return string in the format read by Life(istream&)
+ */
+string gliderBoard(int size, CellChar cellChar) {
+  const char* glider[] = {".*.", "..*", "***"};
+  ostringstream out;
+  out << size << '\n' << size << '\n';
+  string row(size + 1, '\n');
+  for(int r = 0; r < size; r++) {
+    for(int c = 0; c < size; c++)
+      row[c] = cellChar(r % 8 < 3 && c % 8 < 3 && glider[r % 8][c % 8] == '*');
+    out << row;
+  }
+  return out.str();
+}
+
+// -------
+// measure
+// -------
+
+/**
+ * Get the wall clock time
+ * @return double the seconds since the epoch.
+ */
+double now() {
+  timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec + t.tv_usec / 1e6;
+}
+
+/**
+ * The measurements of one benchmark run
+ */
+struct Result {
+  double seconds;
+  long allocated;
+  long peakRSS;
+};
+
+/**
+ * Run a benchmark in a child process, so that the peak resident set size
+ * is that of this run alone and not of every run before it.  The child
+ * sends the time and allocations back through a pipe, and the peak RSS in
+ * kilobytes comes from wait4().
+ * @param benchmark a functor returning the Result of one run
+ * @return Result the measurements of the run.
+ */
+template <typename B>
+Result measure(const B& benchmark) {
+  int fds[2];
+  if(pipe(fds) != 0) {
+    perror("pipe");
+    exit(1);
+  }
+  pid_t pid = fork();
+  if(pid < 0) {
+    perror("fork");
+    exit(1);
+  }
+  if(pid == 0) {
+    close(fds[0]);
+    Result result = benchmark();
+    _exit(write(fds[1], &result, sizeof(result)) == sizeof(result) ? 0 : 1);
+  }
+  close(fds[1]);
+  Result result;
+  ssize_t got = read(fds[0], &result, sizeof(result));
+  close(fds[0]);
+  int status;
+  rusage usage;
+  if(wait4(pid, &status, 0, &usage) != pid || status != 0 || got != sizeof(result)) {
+    cerr << "benchmark failed" << endl;
+    exit(1);
+  }
+  result.peakRSS = usage.ru_maxrss;
+  return result;
+}
+
+/**
+ * Print the measurements of one run to cout and csv
+ * @param engine the name of the engine, e.g. "Life<Cell>"
+ * @param board the name of the board, e.g. "random"
+ * @param size the number of rows and columns on the board
+ * @param density the fraction of cells alive at the start
+ * @param generations the number of generations run
+ * @param cells the number of cells computed per generation
+ * @param result the measurements of the run
+ * @param csv the ostream& to write the CSV line to
+ */
+void report(const char* engine, const string& board, int size, double density, int generations, double cells,
+            const Result& result, ostream& csv) {
+  double cellsPerSecond = cells * generations / result.seconds;
+  double nsPerGeneration = result.seconds * 1e9 / generations;
+  cout << setw(18) << left << engine << setw(8) << board << right << fixed
+       << setw(6) << size << setprecision(2) << setw(6) << density << setw(5) << generations << " gens"
+       << setprecision(0) << setw(12) << cellsPerSecond << " cells/s" << setw(12) << nsPerGeneration << " ns/gen"
+       << setw(8) << result.peakRSS << " KB " << result.allocated << " allocations" << endl;
+  csv << engine << ',' << board << ',' << size << ',' << size << ',' << density << ',' << generations << ','
+      << result.seconds << ',' << cellsPerSecond << ',' << nsPerGeneration << ',' << result.peakRSS << ','
+      << result.allocated << endl;
+}
+
+/**
+ * One Life<T> run over a board
+ */
+template <typename T>
+struct LifeRun {
+  const string* text;
+  int generations;
+  
+  Result operator()() const {
+    istringstream in(*text);
+    Life<T> l(in);
+    Result result;
+    long before = allocations;
+    double start = now();
+    l.simulate(generations);
+    result.seconds = now() - start;
+    result.allocated = allocations - before;
+    return result;
+  }
+};
+
+/**
+ * Run a board for enough generations to take a measurable time, and
+ * print the results to cout and csv.
+ * @param engine the name of the engine, e.g. "Life<Cell>"
+ * @param board the name of the board, e.g. "random"
+ * @param density the fraction of cells alive at the start
+ * @param text the board in the format read by Life(istream&)
+ * @param size the number of rows and columns on the board
+ * @param csv the ostream& to write the CSV line to
+ */
+template <typename T>
+void bench(const char* engine, const char* board, double density, const string& text, int size, ostream& csv) {
+  double cells = (double) size * size;
+  int generations = (int) (2e7 / cells);
+  if(generations < 2)
+    generations = 2;
+  if(generations > 200)
+    generations = 200;
+
+  LifeRun<T> run;
+  run.text = &text;
+  run.generations = generations;
+  report(engine, board, size, density, generations, cells, measure(run), csv);
+}
+
+/**
+ * Run every board of one size on one engine
+ * @param engine the name of the engine
+ * @param cellChar the char of an alive or dead cell of the engine
+ * @param size the number of rows and columns on the board
+ * @param csv the ostream& to write the CSV lines to
+ */
+template <typename T>
+void benchSize(const char* engine, CellChar cellChar, int size, ostream& csv) {
+  const double densities[] = {0.1, 0.35, 0.6};
+  for(int i = 0; i < (int) (sizeof(densities) / sizeof(densities[0])); i++)
+    bench<T>(engine, "random", densities[i], randomBoard(size, densities[i], cellChar), size, csv);
+  bench<T>(engine, "gliders", 5.0 / 64, gliderBoard(size, cellChar), size, csv);
+}
+
+/**
+ * Many small Conway boards run either one Life<ConwayCell> at a time or
+ * all together in one BatchLife
+ */
+struct BatchRun {
+  const vector<string>* text;
+  int generations;
+  bool batched;
+  
+  Result operator()() const {
+    Result result;
+    long before = allocations;
+    double start = now();
+    if(!batched)
+      for(unsigned int b = 0; b < text->size(); b++) {
+        istringstream in((*text)[b]);
+        Life<ConwayCell> l(in);
+        l.simulate(generations);
+      }
+    else {
+      BatchLife batch;
+      for(unsigned int b = 0; b < text->size(); b++) {
+        istringstream in((*text)[b]);
+        batch.add(in);
+      }
+      batch.simulate(generations);
+    }
+    result.seconds = now() - start;
+    result.allocated = allocations - before;
+    return result;
+  }
+};
+
+/**
+ * Run many small random Conway boards, first one Life<ConwayCell> at a
+ * time and then all together in one BatchLife, and print the results to
+ * cout and csv.
+ * @param count the number of boards
+ * @param size the number of rows and columns on each board
+ * @param csv the ostream& to write the CSV lines to
+ */
+void benchBatch(int count, int size, ostream& csv) {
+  const double density = 0.35;
+  vector<string> text;
+  for(int b = 0; b < count; b++)
+    text.push_back(randomBoard(size, density, conwayChar));
+  ostringstream board;
+  board << "batch" << count;
+
+  BatchRun run;
+  run.text = &text;
+  run.generations = 50;
+  for(int pass = 0; pass < 2; pass++) {
+    run.batched = pass == 1;
+    report(run.batched ? "BatchLife" : "Life<ConwayCell>", board.str(), size, density, run.generations,
+           (double) count * size * size, measure(run), csv);
+  }
+}
+
+// ----
+// main
+// ----
+
+int main (int argc, char* argv[]) {
+  using namespace std;
+  ios_base::sync_with_stdio(false); // turn off synchronization with C I/O
+  srand(0);
+
+  const char* fileName = "BenchLife.csv";
+  vector<int> sizes;
+  for(int i = 1; i < argc; i++) {
+    if(strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+      fileName = argv[++i];
+    else if(atoi(argv[i]) > 0)
+      sizes.push_back(atoi(argv[i]));
+    else {
+      cerr << "usage: " << argv[0] << " [-o results.csv] [size ...]" << endl;
+      return 1;
+    }
+  }
+  if(sizes.empty()) {
+    const int defaults[] = {20, 128, 512, 1024};
+    sizes.assign(defaults, defaults + 4);
+  }
+
+  ofstream csv(fileName);
+  csv << "engine,board,rows,cols,density,generations,seconds,cells_per_sec,ns_per_gen,peak_rss_kb,allocations" << endl;
+  for(unsigned int i = 0; i < sizes.size(); i++) {
+    benchSize<ConwayCell>("Life<ConwayCell>", conwayChar, sizes[i], csv);
+    benchSize<FredkinCell>("Life<FredkinCell>", fredkinChar, sizes[i], csv);
+    benchSize<Cell>("Life<Cell>", mixedChar, sizes[i], csv);
+  }
+  benchBatch(1024, 64, csv);
+
+  return 0;
+}
@@ -1,7 +1,37 @@
+#include <algorithm> // copy, fill, sort, unique
+#include <cctype>    // isalpha, isdigit, isspace
+#include <cstdio>    // rename
+#include <cstring>   // memcmp, memcpy
 #include <iostream>
+#include <sstream>   // ostringstream
 #include <string>
 #include <vector>
-#include <stdexcept> // invalid_argument, out_of_range
+#include <stdexcept> // invalid_argument, out_of_range, runtime_error
+#include <stdint.h>  // int32_t, uint64_t
+#include <pthread.h> // pthread_create, pthread_barrier_wait
+#include <map>       // map
+#include <set>       // set
+#include <utility>   // pair, make_pair
+#include <fcntl.h>     // open
+#include <semaphore.h> // sem_init, sem_post, sem_timedwait, sem_wait
+#include <signal.h>    // kill
+#include <sys/mman.h>  // mmap, munmap, shm_open, shm_unlink
+#include <sys/stat.h>  // fstat
+#include <sys/wait.h>  // waitpid
+#include <time.h>      // clock_gettime
+#include <unistd.h>    // close, fork, fsync, ftruncate, write
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LIFE_X86
+#include <immintrin.h> // _mm_xor_si128, _mm256_xor_si256
+#endif
+
+#ifdef LIFE_STATS
+#include <sys/time.h>  // gettimeofday
+#ifndef LIFE_STATS_RING
+#define LIFE_STATS_RING 1024 // a power of 2
+#endif
+#endif
 
 using namespace std;
 class Position {
@@ -38,57 +68,246 @@ static const Position fnarr[] = {NORTH, EAST, SOUTH, WEST};
 static const vector<Position> conwayNeighbors(cnarr, cnarr + 8);
 static const vector<Position> fredkinNeighbors(fnarr, fnarr + 4);
 
+class Pattern {
+ public:
+  enum Format {NATIVE, PLAINTEXT, RLE};
+  
+  Format format;
+  int rows;
+  int cols;
+  vector<char> cells;
+  
+  Pattern(const char* fileName);
+  Pattern(const char* data, size_t size);
+  
+ private:
+  void parse(const char* data, const char* end);
+  void parseNative(const char* p, const char* end);
+  void parsePlaintext(const char* p, const char* end);
+  void parseRLE(const char* p, const char* end);
+};
+
+template <typename T>
+char patternChar(bool alive);
+
+template <typename T>
+int16_t checkpointType();
+
+struct CellState {
+  enum Kind {CONWAY, FREDKIN};
+  
+  Kind kind;
+  bool alive;
+  int age;
+};
+
+#ifdef LIFE_STATS
+struct GenerationStats {
+  int generation;
+  int population;
+  int births;
+  int deaths;
+  int promotions;
+  double countSeconds;
+  double turnSeconds;
+};
+
+typedef void (*StatsCallback)(const GenerationStats& stats, void* context);
+#endif
+
+struct CheckpointHeader {
+  static const uint32_t VERSION = 2;
+  
+  char magic[8];
+  uint32_t version;
+  int32_t rows;
+  int32_t cols;
+  int32_t generation;
+  int32_t population;
+  int16_t cellType;
+  int16_t boundary;
+};
+
+template <typename T>
+class ShardLife;
+
 template <typename T>
 class Life {
+ public:
+  enum Boundary {DEAD, TOROIDAL};
+  enum SnapshotFormat {FULL, DELTA};
+  
  private:
-  vector< vector<T> > grid;
+  friend class ShardLife<T>;
+  
+  struct Worker {
+    Life* life;
+    int band;
+  };
+  
+  struct Snapshot {
+    int generation;
+    int population;
+    vector<T> cells;
+  };
+  
+  vector<T> grid;
+  vector<T> next;
+  int rows;
+  int cols;
+  int stride;
   int generation;
   int population;
-  Position current;
+  Boundary boundary;
+  
+  int numThreads;
+  vector<pthread_t> threads;
+  vector<Worker> workers;
+  vector<int> bandPopulation;
+  vector<vector<int> > bandCounts;
+  pthread_mutex_t poolLock;
+  pthread_barrier_t startBarrier;
+  pthread_barrier_t turnBarrier;
+  int pendingTurns;
+  bool stopping;
+  
+  bool incremental;
+  vector<int> active;
+  vector<char> marked;
+  vector<int> changedIndex;
+  vector<T> changedCells;
+  
+  vector<char> snapshot;
   
+  ostream* snapshotOut;
+  SnapshotFormat snapshotFormat;
+  int snapshotEvery;
+  vector<Snapshot> snapshots;
+  vector<int> freeSnapshots;
+  vector<int> queuedSnapshots;
+  vector<char> writtenNames;
+  bool writerStopping;
+  pthread_t writer;
+  pthread_mutex_t snapshotLock;
+  pthread_cond_t snapshotFree;
+  pthread_cond_t snapshotQueued;
+  
+  bool detectCycles;
+  vector<T> startGrid;
+  int startGeneration;
+  vector<T> cycleGrid;
+  uint64_t cycleHash;
+  int cycleGeneration;
+  int cycleLength;
+  int matchGeneration;
+  int period;
+  int transient;
+  
+#ifdef LIFE_STATS
+  GenerationStats stats;
+  GenerationStats statsRing[LIFE_STATS_RING];
+  volatile unsigned int statsHead;
+  volatile unsigned int statsTail;
+  unsigned int statsDropped;
+  StatsCallback statsCallback;
+  void* statsContext;
+  
+  static double now();
+  void countChange(const T& before, const T& after);
+  void recordStats();
+#endif
+  
+  Life(const Life&);
+  Life& operator = (const Life&);
+  Life(int rows, int cols);
+  void init();
+  
+  int index(int r, int c) const;
+  void pad();
+  void fillHalo();
+  bool sameBoard(const vector<T>& other) const;
+  int countNeighbors(int i);
   void takeTurn();
+  void takeTurnIncremental();
+  void markActive(int r, int c);
+  bool restore(const char* fileName);
+  void writeBoard(ostream& out, int gen, int pop, const vector<T>& cells) const;
+  void writeDelta(ostream& out, int gen, int pop, const vector<T>& cells, vector<char>& last) const;
+  void publish();
+  static void* writeSnapshots(void* arg);
+  void runTurns(int numTurns);
+  void advance(int numTurns);
+  uint64_t hashGrid() const;
+  void checkHash();
+  void loadCopy(Life<T>& copy, const vector<T>& board) const;
+  void findTransient();
+  void findCycle();
+  int turnRows(int first, int last, vector<int>& counts);
+  void runBand(int band);
+  void startPool();
+  void stopPool();
+  static void* work(void* arg);
   
  public:
   Life(istream& in);
+  Life(const char* fileName);
+  ~Life();
   void simulate(int numTurns);    
   void print(ostream& out);
+  void printDelta(ostream& out);
+  void checkpoint(const char* fileName);
+  void startSnapshots(ostream& out, int every, int depth = 2, SnapshotFormat format = FULL);
+  void stopSnapshots();
+  void setThreads(int n);
+  void setIncremental(bool on);
+  void setBoundary(Boundary b);
+  void setCycleDetection(bool on);
+  int getPeriod() const;
+  int getTransient();
+#ifdef LIFE_STATS
+  void setStatsCallback(StatsCallback callback, void* context);
+  int drainStats(vector<GenerationStats>& out);
+  unsigned int droppedStats() const;
+#endif
   
-  void countNeighbors(T&);
+  T& at(int r, int c);
+  int countNeighbors(int r, int c);
   bool isAlive(Position);
 };
 
 class AbstractCell {
- protected:
-  int numNeighbors;
-  
  public:
   bool alive;
   virtual char name() const = 0;
-  virtual void turn() = 0;
+  virtual void turn(int) = 0;
   virtual const vector<Position>& neighbors() const = 0;
   
   virtual operator bool ();
   virtual operator int ();
   
-  virtual void setNeighbors(int);
-  
   virtual AbstractCell* clone() const = 0;
 };
 
 class Cell {
+ public:
+  enum Kind {CONWAY, FREDKIN};
+  
  private:
-  AbstractCell* ptr;
+  Kind kind;
+  bool alive;
+  int age;
+  
  public:
+  Cell();
   Cell(char);
-  Cell(const Cell&);
-  Cell& operator = (Cell);
-  ~Cell();
+  Cell(const CellState&);
   
-  void turn();
+  CellState state() const;
+  void turn(int);
   const vector<Position>& neighbors() const;
   char name() const;
   
-  void setNeighbors(int);
+  bool operator == (const Cell&) const;
   
   operator bool();
   operator int();
@@ -97,12 +316,17 @@ class Cell {
 
 class ConwayCell : public AbstractCell {
  public:
+  ConwayCell();
   ConwayCell(char);
+  ConwayCell(const CellState&);
   
-  void turn();
+  CellState state() const;
+  void turn(int);
   const vector<Position>& neighbors() const;
   char name() const;
   
+  bool operator == (const ConwayCell&) const;
+  
   AbstractCell* clone() const;
 };
 
@@ -110,16 +334,305 @@ class FredkinCell : public AbstractCell {
  private:
   int age;
  public:
+  FredkinCell();
   FredkinCell(char);
+  FredkinCell(const CellState&);
   
-  void turn();
+  CellState state() const;
+  void turn(int);
   const vector<Position>& neighbors() const;
   char name() const;
   
+  bool operator == (const FredkinCell&) const;
+  
   AbstractCell* clone() const;
   operator int();
 };
 
+class BitLife {
+ private:
+  vector<uint64_t> grid;
+  vector<uint64_t> next;
+  int rows;
+  int cols;
+  int wordsPerRow;
+  uint64_t lastMask;
+  int generation;
+  int population;
+  
+  void takeTurn();
+  
+ public:
+  BitLife(istream& in);
+  void simulate(int numTurns);
+  void print(ostream& out);
+  
+  bool isAlive(int r, int c) const;
+};
+
+class HashLife {
+ private:
+  enum State {DEAD, ALIVE, WALL};
+  
+  struct Node {
+    Node* nw;
+    Node* ne;
+    Node* sw;
+    Node* se;
+    Node* result;
+    Node* chain;
+    int level;
+    int resultStep;
+    int population;
+    State state;
+    bool marked;
+  };
+  
+  vector<Node*> buckets;
+  vector<Node*> walls;
+  vector<Node*> pinned;
+  Node* leaves[3];
+  Node* root;
+  int nodeCount;
+  int peakCount;
+  int maxNodes;
+  int collectAt;
+  int rows;
+  int cols;
+  int top;
+  int left;
+  int generation;
+  int population;
+  
+  HashLife(const HashLife&);
+  HashLife& operator = (const HashLife&);
+  
+  Node* join(Node* nw, Node* ne, Node* sw, Node* se);
+  Node* wall(int level);
+  Node* build(const vector<State>& cells, int level, int r, int c);
+  Node* pad(Node* node);
+  Node* successor(Node* node, int step);
+  Node* turnLeaves(Node* node);
+  State stateAt(Node* node, int r, int c) const;
+  void step(int step);
+  void mark(Node* node);
+  void collect();
+  
+ public:
+  HashLife(istream& in, int maxNodes = 1 << 22);
+  ~HashLife();
+  void simulate(int numTurns);
+  void print(ostream& out);
+  
+  bool isAlive(int r, int c) const;
+  int nodes() const;
+  int peakNodes() const;
+};
+
+class SparseLife {
+ private:
+  struct Tile {
+    uint64_t bits[64];
+  };
+  typedef pair<int, int> Key;
+  typedef map<Key, Tile> TileMap;
+  
+  TileMap tiles;
+  TileMap nextTiles;
+  vector<Key> candidates;
+  int rows;
+  int cols;
+  int generation;
+  int population;
+  
+  static int tileOf(int x);
+  const Tile* find(int tr, int tc) const;
+  void turnTile(int tr, int tc, Tile& out) const;
+  void takeTurn();
+  
+ public:
+  SparseLife(istream& in);
+  void simulate(int numTurns);
+  void print(ostream& out);
+  void print(ostream& out, int top, int left, int numRows, int numCols);
+  
+  bool isAlive(int r, int c) const;
+  void setAlive(int r, int c, bool alive);
+  int tileCount() const;
+};
+
+class FredkinLife {
+ public:
+  enum Kernel {SCALAR, SSE2, AVX2};
+  
+ private:
+  typedef int (*RowKernel)(const uint8_t*, uint8_t*, uint8_t*, int, int);
+  
+  vector<uint8_t> alive;
+  vector<uint8_t> nextAlive;
+  vector<uint8_t> age;
+  int rows;
+  int cols;
+  int stride;
+  int generation;
+  int population;
+  Kernel kernel;
+  RowKernel turnRow;
+  
+  void takeTurn();
+  
+ public:
+  FredkinLife(istream& in);
+  void simulate(int numTurns);
+  void print(ostream& out);
+  
+  static bool supported(Kernel k);
+  void setKernel(Kernel k);
+  Kernel getKernel() const;
+  
+  bool isAlive(int r, int c) const;
+  int getAge(int r, int c) const;
+};
+
+template <unsigned int B, unsigned int S>
+struct Rule {
+  static bool next(bool alive, int numNeighbors);
+};
+
+typedef Rule<1 << 3, 1 << 2 | 1 << 3> ConwayRule;
+typedef Rule<1 << 3 | 1 << 6, 1 << 2 | 1 << 3> HighLifeRule;
+typedef Rule<1 << 2, 0> SeedsRule;
+typedef Rule<1 << 1 | 1 << 3, 1 << 1 | 1 << 3> FredkinRule;
+
+struct NoOffset {
+  static const int radius = 0;
+  static int count(const uint8_t*, int);
+};
+
+template <int R, int C, typename Next = NoOffset>
+struct Offset {
+  static const int radius = (R < 0 ? -R : R) > (C < 0 ? -C : C) ?
+    ((R < 0 ? -R : R) > Next::radius ? (R < 0 ? -R : R) : Next::radius) :
+    ((C < 0 ? -C : C) > Next::radius ? (C < 0 ? -C : C) : Next::radius);
+  static int count(const uint8_t* cell, int stride);
+};
+
+typedef Offset<-1, -1, Offset<-1, 0, Offset<-1, 1, Offset<0, -1,
+        Offset<0, 1, Offset<1, -1, Offset<1, 0, Offset<1, 1> > > > > > > > Moore;
+typedef Offset<-1, 0, Offset<0, -1, Offset<0, 1, Offset<1, 0> > > > VonNeumann;
+
+template <typename R, typename N>
+class RuleLife {
+ private:
+  vector<uint8_t> grid;
+  vector<uint8_t> next;
+  int rows;
+  int cols;
+  int stride;
+  int generation;
+  int population;
+  
+  int index(int r, int c) const;
+  void takeTurn();
+  
+ public:
+  RuleLife(istream& in);
+  RuleLife(const char* fileName);
+  void simulate(int numTurns);
+  void print(ostream& out);
+  
+  bool isAlive(int r, int c) const;
+};
+
+class BatchLife {
+ private:
+  struct Slice {
+    vector<uint64_t> grid;
+    vector<uint64_t> next;
+    int rows;
+    int cols;
+    int boards;
+    int generation;
+  };
+  
+  struct Board {
+    int slice;
+    int lane;
+  };
+  
+  vector<Slice> slices;
+  vector<Board> boards;
+  map<pair<int, int>, int> openSlice;
+  int numThreads;
+  int pendingTurns;
+  int nextSlice;
+  
+  BatchLife(const BatchLife&);
+  BatchLife& operator = (const BatchLife&);
+  
+  void turnSlice(Slice& slice);
+  void runSlices();
+  static void* work(void* arg);
+  
+ public:
+  BatchLife();
+  int add(istream& in);
+  void simulate(int numTurns);
+  void print(int i, ostream& out);
+  void setThreads(int n);
+  
+  int size() const;
+  int getPopulation(int i) const;
+  bool isAlive(int i, int r, int c) const;
+};
+
+template <typename T>
+class ShardLife {
+ private:
+  enum Command {STEP, GATHER, STOP};
+  
+  struct Control {
+    pthread_barrier_t turn;
+    Command next;
+    int argument;
+  };
+  
+  int rows;
+  int cols;
+  int generation;
+  int population;
+  int numWorkers;
+  vector<pid_t> workers;
+  
+  void* shared;
+  size_t sharedSize;
+  Control* control;
+  sem_t* commands;
+  sem_t* finished;
+  int* populations;
+  CellState* edges;
+  CellState* staging;
+  
+  ShardLife(const ShardLife&);
+  ShardLife& operator = (const ShardLife&);
+  
+  int firstRow(int worker) const;
+  void unmap();
+  void stopWorkers();
+  void runCommand(Command c, int arg);
+  void awaitWorkers();
+  void work(int worker, Life<T>& band);
+  void exchange(int worker, Life<T>& band);
+  
+ public:
+  ShardLife(istream& in, int numWorkers);
+  ~ShardLife();
+  void simulate(int numTurns);
+  void print(ostream& out);
+  
+  int getPopulation() const;
+};
+
 // --------
 // position
 // --------
@@ -143,351 +656,3503 @@ Position& Position::operator +=(const Position& rhs) {
   return *this;
 }
 
-// ----
-// Life
-// ----
+// -------
+// Pattern
+// -------
 
 /**
- * istream& Life Constructor
- * @param in the istream& to read input from
+ * File Pattern Constructor.  Maps the file into memory and parses it in place.
+ * @param fileName the name of a file in the Life, plaintext (.cells) or RLE format
  */
-template <typename T>
-Life<T>::Life(istream& in) {
-  generation = 0;
-  population = 0;
-  int rows;
-  int cols;
-  in >> rows;
-  in >> cols >> ws;
-  
-  for(int r = 0; r < rows; r++) {
-    grid.push_back(vector<T>());
-    for(int c = 0; c < cols; c++) {
-      char cell;
-      in >> cell;
-      grid[r].push_back(T(cell));
-      if(grid[r][c])
-        population++;
-    }
-    if(in)
-      in >> ws;
+Pattern::Pattern(const char* fileName) {
+  int fd = open(fileName, O_RDONLY);
+  if(fd < 0)
+    throw invalid_argument("cannot open pattern file");
+  struct stat info;
+  if(fstat(fd, &info) < 0 || info.st_size == 0) {
+    close(fd);
+    throw invalid_argument("cannot read pattern file");
+  }
+  size_t size = info.st_size;
+  void* data = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(data == MAP_FAILED)
+    throw invalid_argument("cannot map pattern file");
+  madvise(data, size, MADV_SEQUENTIAL);
+  try {
+    parse((const char*) data, (const char*) data + size);
   }
+  catch(...) {
+    munmap(data, size);
+    throw;
+  }
+  munmap(data, size);
 }
 
 /**
- * Advance the board by one turn.
+ * Buffer Pattern Constructor
+ * @param data the text of a pattern in the Life, plaintext (.cells) or RLE format
+ * @param size the number of chars in data
  */
-template <typename T>
-void Life<T>::takeTurn() {
-  population = 0;
-  for(unsigned int i = 0; i < grid.size(); i++)
-    for(unsigned int j = 0; j < grid[0].size(); j++) {
-      current.r = i;
-      current.c = j;
-      countNeighbors(grid[i][j]);
-    }
-  
-  for(unsigned int i = 0; i < grid.size(); i++) {
-    for(unsigned int j = 0; j < grid[0].size(); j++) {
-      grid[i][j].turn();
-      if (grid[i][j])
-        population++;
-    }
-  }
-  generation++;
+Pattern::Pattern(const char* data, size_t size) {
+  parse(data, data + size);
 }
 
 /**
- * Run the game the specified number of turns
- * @param numTurns the number of turns to run for.
+ * Pick the format from the first char that is not whitespace and parse.
+ * Life files start with the row count, plaintext files with '!', '.' or 'O',
+ * and RLE files with '#' or the "x = " header.
+ * @param data the first char of the pattern
+ * @param end one past the last char of the pattern
  */
-template <typename T>
-void Life<T>::simulate(int numTurns) {
-  while(numTurns-- > 0)
-    takeTurn();
+void Pattern::parse(const char* data, const char* end) {
+  const char* p = data;
+  while(p < end && isspace(*p))
+    p++;
+  if(p == end)
+    throw invalid_argument("empty pattern");
+  if(isdigit(*p))
+    parseNative(p, end);
+  else if(*p == '#' || *p == 'x')
+    parseRLE(p, end);
+  else
+    parsePlaintext(p, end);
 }
 
 /**
- * Print out the current state of the game
- * @param out the ostream& to print out to.
+ * Parse the Life format read by Life(istream&): rows, cols, then one char per cell.
+ * The cell chars are copied as is.
+ * @param p the first char of the pattern
+ * @param end one past the last char of the pattern
  */
-template <typename T>
-void Life<T>::print(ostream& out) {
-  out << "Generation = " << generation << ", Population = " << population << "." << endl;
-  for(unsigned int i = 0; i < grid.size(); i++) {
-    for(unsigned int j = 0; j < grid[0].size(); j++)
-      out << grid[i][j].name();
-    out << endl;
+void Pattern::parseNative(const char* p, const char* end) {
+  format = NATIVE;
+  rows = 0;
+  cols = 0;
+  while(p < end && isspace(*p))
+    p++;
+  while(p < end && isdigit(*p))
+    rows = rows * 10 + (*p++ - '0');
+  while(p < end && isspace(*p))
+    p++;
+  while(p < end && isdigit(*p))
+    cols = cols * 10 + (*p++ - '0');
+  
+  cells.resize(rows * cols);
+  char* out = cells.empty() ? 0 : &cells[0];
+  char* last = out + cells.size();
+  while(out < last) {
+    while(p < end && isspace(*p))
+      p++;
+    const char* run = p;
+    while(p < end && !isspace(*p) && out + (p - run) < last)
+      p++;
+    if(p == run)
+      throw invalid_argument("pattern has fewer cells than rows * cols");
+    copy(run, p, out);
+    out += p - run;
   }
-  out << endl;
 }
 
 /**
- * Count and set the number of alive neighbors of the specified cell.
- * @param cell the cell to count the neighbors of
+ * Parse the plaintext (.cells) format: '!' comment lines, then one line per
+ * row with 'O' for alive and '.' for dead.  Short rows are padded with dead
+ * cells.  Cells are stored as '*' and '.'.
+ * @param p the first char of the pattern
+ * @param end one past the last char of the pattern
  */
-template <typename T>
-void Life<T>::countNeighbors(T& cell) {
-  vector<Position> adjacent = cell.neighbors();
-  int numNeighbors = 0;
-  for(unsigned int i = 0; i < adjacent.size(); i++) {
-    numNeighbors += isAlive(adjacent[i]);
+void Pattern::parsePlaintext(const char* p, const char* end) {
+  format = PLAINTEXT;
+  vector< pair<const char*, int> > lines;
+  cols = 0;
+  while(p < end) {
+    const char* eol = p;
+    while(eol < end && *eol != '\n')
+      eol++;
+    int length = eol - p;
+    if(length > 0 && p[length - 1] == '\r')
+      length--;
+    if(*p != '!') {
+      lines.push_back(make_pair(p, length));
+      if(length > cols)
+        cols = length;
+    }
+    p = eol + 1;
   }
-  cell.setNeighbors(numNeighbors);
+  rows = lines.size();
+  cells.assign(rows * cols, '.');
+  for(int r = 0; r < rows; r++)
+    for(int c = 0; c < lines[r].second; c++) {
+      char cell = lines[r].first[c];
+      if(cell != '.' && !isspace(cell))
+        cells[r * cols + c] = '*';
+    }
 }
 
 /**
- * see if the specified cell is alive
- * @param adj a Position specifying the grid location of the cell to check relative to current location.
- * @return bool representing if the cell is alive or not.
+ * Parse the run length encoded (RLE) format: '#' comment lines, an
+ * "x = cols, y = rows" header, then runs of 'b' (dead) or any other letter
+ * (alive), with '$' ending a row and '!' ending the pattern.
+ * Cells are stored as '*' and '.'.
+ * @param p the first char of the pattern
+ * @param end one past the last char of the pattern
  */
-template <typename T>
-bool Life<T>::isAlive(Position adj) {
-  Position p = current + adj;
-  if(p.r < 0 || p.r >= (int)grid.size() || p.c < 0 || p.c >= (int)grid[0].size()) 
-    return false;
-  return grid[p.r][p.c];
+void Pattern::parseRLE(const char* p, const char* end) {
+  format = RLE;
+  while(p < end && *p == '#') {
+    while(p < end && *p != '\n')
+      p++;
+    while(p < end && isspace(*p))
+      p++;
+  }
+  
+  rows = -1;
+  cols = -1;
+  while(p < end && *p != '\n') {
+    char key = *p++;
+    if(!(key == 'x' && cols < 0) && !(key == 'y' && rows < 0))
+      continue;
+    if(p < end && isalpha(*p))
+      continue;
+    while(p < end && (isspace(*p) || *p == '=') && *p != '\n')
+      p++;
+    int value = 0;
+    while(p < end && isdigit(*p))
+      value = value * 10 + (*p++ - '0');
+    if(key == 'x')
+      cols = value;
+    else
+      rows = value;
+  }
+  if(rows < 0 || cols < 0)
+    throw invalid_argument("RLE pattern has no x = , y = header");
+  
+  cells.assign(rows * cols, '.');
+  int r = 0;
+  int c = 0;
+  int count = 0;
+  for(; p < end && *p != '!'; p++) {
+    if(isdigit(*p)) {
+      count = count * 10 + (*p - '0');
+      continue;
+    }
+    if(isspace(*p))
+      continue;
+    int n = count ? count : 1;
+    count = 0;
+    if(*p == '$') {
+      r += n;
+      c = 0;
+    }
+    else if(*p == 'b')
+      c += n;
+    else {
+      if(r >= rows || c + n > cols)
+        throw invalid_argument("RLE pattern is larger than its header");
+      fill(&cells[r * cols + c], &cells[r * cols + c] + n, '*');
+      c += n;
+    }
+  }
 }
 
-// -------------
-// Abstract Cell
-// -------------
-
 /**
- * Set the neighbor count to the given value
- * @param n the value to set numNeighbors to.
+ * Get the char T(char) takes for a cell of a plaintext or RLE pattern.
+ * @param alive whether the pattern cell is alive
+ * @return char '*' or '.', the Conway cell chars.
  */
-void AbstractCell::setNeighbors(int n) {
-  if(n < 0 || n > 8) throw(invalid_argument("n must be between 0 and 8, inclusive"));
-  numNeighbors = n;
+template <typename T>
+char patternChar(bool alive) {
+  return alive ? '*' : '.';
 }
 
 /**
- * Conversion to bool representing the aliveness of the cell.
- * @return bool representing whether the cell is alive or not
+ * Get the char FredkinCell(char) takes for a cell of a plaintext or RLE pattern.
+ * @param alive whether the pattern cell is alive
+ * @return char '0' or '-'.
  */
-AbstractCell::operator bool() {
-  return alive;
+template <>
+char patternChar<FredkinCell>(bool alive) {
+  return alive ? '0' : '-';
 }
 
 /**
- * Conversion to int representing the age of the cell.  Defaults to 0.
- * @return 0
+ * Get the cell type recorded in a checkpoint of Life<T>.
+ * @return int16_t 0 for a cell type with no checkpoint type of its own.
  */
-AbstractCell::operator int() {
+template <typename T>
+int16_t checkpointType() {
   return 0;
 }
 
-// ----
-// Cell
-// ----
-
 /**
- * char constructor for Cell.  Creates a new Conway or Fredkin cell depending on input.
- * @param c char representing the type and state of the cell to be created.
+ * Get the cell type recorded in a checkpoint of Life<ConwayCell>.
+ * @return int16_t 1.
  */
-Cell::Cell(char c){
-  if(c == '.'|| c == '*')
-    ptr = new ConwayCell(c);
-  else
-    ptr = new FredkinCell(c);
+template <>
+int16_t checkpointType<ConwayCell>() {
+  return 1;
 }
 
 /**
- * Copy constructor
- * @param other the Cell to copy
+ * Get the cell type recorded in a checkpoint of Life<FredkinCell>.
+ * @return int16_t 2.
  */
-Cell::Cell(const Cell& other) {
-  if (!other.ptr)
-    ptr = 0;
-  else
-    ptr = other.ptr->clone();
+template <>
+int16_t checkpointType<FredkinCell>() {
+  return 2;
 }
 
 /**
- * Copy assignment
- * @param other the Cell to copy
+ * Get the cell type recorded in a checkpoint of Life<Cell>.
+ * @return int16_t 3.
  */
-Cell& Cell::operator = (Cell other) {
-  swap(ptr, other.ptr);
-  return *this;
+template <>
+int16_t checkpointType<Cell>() {
+  return 3;
 }
 
-/**
- * Destructor.  Deletes ptr.
- */  
-Cell::~Cell() {
-  delete ptr;
-}
+// ----
+// Life
+// ----
 
 /**
- * Advance the state of the Cell by one turn.  Assumes numNeighbors has been set
+ * Set every member but the board to its starting value: one thread, no
+ * incremental turns, a dead boundary, no snapshots, no cycle detection
+ * and, with LIFE_STATS, no statistics.  Shared by the constructors.
  */
-void Cell::turn() {
-  ptr->turn();
-  if(*ptr == 2 && *ptr) {
-    delete ptr;
-    ptr = new ConwayCell('*');  
-  }
+template <typename T>
+void Life<T>::init() {
+  generation = 0;
+  population = 0;
+  numThreads = 1;
+  pendingTurns = 0;
+  stopping = false;
+  incremental = false;
+  boundary = DEAD;
+  snapshotOut = 0;
+  snapshotFormat = FULL;
+  snapshotEvery = 1;
+  writerStopping = false;
+  detectCycles = false;
+  startGeneration = 0;
+  cycleHash = 0;
+  cycleGeneration = 0;
+  cycleLength = 1;
+  matchGeneration = 0;
+  period = 0;
+  transient = 0;
+#ifdef LIFE_STATS
+  stats = GenerationStats();
+  statsHead = 0;
+  statsTail = 0;
+  statsDropped = 0;
+  statsCallback = 0;
+  statsContext = 0;
+#endif
 }
 
 /**
- * Get a Position vector representing the Positions to consider as neighbors.
- * @return const vector<Position>& representing the relative Positions to consider as neighbors.
- */
+ * istream& Life Constructor
+ * @param in the istream& to read input from
+ */
+template <typename T>
+Life<T>::Life(istream& in) {
+  init();
+  in >> rows;
+  in >> cols >> ws;
+  
+  grid.reserve(rows * cols);
+  for(int r = 0; r < rows; r++) {
+    for(int c = 0; c < cols; c++) {
+      char cell;
+      in >> cell;
+      grid.push_back(T(cell));
+      if(grid.back())
+        population++;
+    }
+    if(in)
+      in >> ws;
+  }
+  pad();
+}
+
+/**
+ * Dead Life Constructor, used by ShardLife for the band of each worker.
+ * @param rows the number of rows on the board
+ * @param cols the number of columns on the board
+ */
+template <typename T>
+Life<T>::Life(int rows, int cols) : rows(rows), cols(cols) {
+  init();
+  grid.assign(rows * cols, T());
+  pad();
+}
+
+/**
+ * File Life Constructor.  Maps the file into memory instead of reading it
+ * through a stream.  Accepts a checkpoint written by checkpoint(), the
+ * format read by Life(istream&), and the plaintext (.cells) and RLE
+ * pattern formats, whose cells become Conway cells, or age 0 Fredkin cells
+ * for Life<FredkinCell>.
+ * @param fileName the name of the file to read
+ */
+template <typename T>
+Life<T>::Life(const char* fileName) {
+  init();
+  
+  if(restore(fileName))
+    return;
+  Pattern pattern(fileName);
+  rows = pattern.rows;
+  cols = pattern.cols;
+  grid.reserve(rows * cols);
+  for(int i = 0; i < rows * cols; i++) {
+    char cell = pattern.cells[i];
+    if(pattern.format != Pattern::NATIVE)
+      cell = patternChar<T>(cell == '*');
+    grid.push_back(T(cell));
+    if(grid.back())
+      population++;
+  }
+  pad();
+}
+
+/**
+ * Load the board from a checkpoint written by checkpoint().  The file is
+ * mapped into memory and the cells are built straight from its planes.
+ * @param fileName the name of the file to read
+ * @return bool false if the file is not a checkpoint.
+ */
+template <typename T>
+bool Life<T>::restore(const char* fileName) {
+  int fd = open(fileName, O_RDONLY);
+  if(fd < 0)
+    return false;
+  struct stat info;
+  if(fstat(fd, &info) < 0 || info.st_size < (off_t) sizeof(CheckpointHeader)) {
+    close(fd);
+    return false;
+  }
+  size_t size = info.st_size;
+  void* data = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(data == MAP_FAILED)
+    return false;
+  
+  CheckpointHeader header;
+  memcpy(&header, data, sizeof(header));
+  if(memcmp(header.magic, "LIFECKPT", 8) != 0) {
+    munmap(data, size);
+    return false;
+  }
+  // each cell takes 6 bytes, so this bounds rows * cols before multiplying
+  size_t limit = (size - sizeof(header)) / 6;
+  if(header.version != CheckpointHeader::VERSION || header.rows < 0 || header.cols < 0 ||
+     (header.cols > 0 && (size_t) header.rows > limit / header.cols)) {
+    munmap(data, size);
+    throw invalid_argument("unsupported or truncated checkpoint");
+  }
+  size_t n = (size_t) header.rows * header.cols;
+  size_t ageOffset = (sizeof(header) + 2 * n + 3) / 4 * 4;
+  if(size < ageOffset + n * sizeof(int32_t)) {
+    munmap(data, size);
+    throw invalid_argument("truncated checkpoint");
+  }
+  if(header.cellType != checkpointType<T>()) {
+    munmap(data, size);
+    throw invalid_argument("checkpoint holds a different cell type");
+  }
+  if(header.boundary != DEAD && header.boundary != TOROIDAL) {
+    munmap(data, size);
+    throw invalid_argument("corrupt checkpoint");
+  }
+  
+  const unsigned char* kinds = (const unsigned char*) data + sizeof(header);
+  const unsigned char* alive = kinds + n;
+  const int32_t* ages = (const int32_t*) ((const char*) data + ageOffset);
+  rows = header.rows;
+  cols = header.cols;
+  generation = header.generation;
+  population = header.population;
+  grid.reserve(n);
+  for(size_t i = 0; i < n; i++) {
+    if(kinds[i] > CellState::FREDKIN || alive[i] > 1) {
+      munmap(data, size);
+      throw invalid_argument("corrupt checkpoint");
+    }
+    CellState state;
+    state.kind = (CellState::Kind) kinds[i];
+    state.alive = alive[i];
+    state.age = ages[i];
+    grid.push_back(T(state));
+  }
+  pad();
+  boundary = (Boundary) header.boundary;
+  munmap(data, size);
+  return true;
+}
+
+/**
+ * Write the board to a binary checkpoint that Life(const char*) restores
+ * exactly, Fredkin ages included.  The header records the cell type and
+ * the boundary, and only a Life of the same cell type restores it.  The file is a CheckpointHeader, a byte
+ * plane of cell kinds, a byte plane of alive flags and, at the next 4 byte
+ * boundary, a plane of int32_t ages, all in host byte order.  It is written
+ * to fileName.tmp and renamed, so an interrupted write leaves any earlier
+ * checkpoint in place.
+ * @param fileName the name of the file to write
+ */
+template <typename T>
+void Life<T>::checkpoint(const char* fileName) {
+  CheckpointHeader header;
+  memcpy(header.magic, "LIFECKPT", 8);
+  header.version = CheckpointHeader::VERSION;
+  header.rows = rows;
+  header.cols = cols;
+  header.generation = generation;
+  header.population = population;
+  header.cellType = checkpointType<T>();
+  header.boundary = boundary;
+  
+  size_t n = (size_t) rows * cols;
+  size_t ageOffset = (sizeof(header) + 2 * n + 3) / 4 * 4;
+  vector<char> buffer(ageOffset + n * sizeof(int32_t), 0);
+  memcpy(&buffer[0], &header, sizeof(header));
+  for(size_t i = 0; i < n; i++) {
+    CellState state = grid[index(i / cols, i % cols)].state();
+    buffer[sizeof(header) + i] = (char) state.kind;
+    buffer[sizeof(header) + n + i] = state.alive;
+    int32_t age = state.age;
+    memcpy(&buffer[ageOffset + i * sizeof(int32_t)], &age, sizeof(age));
+  }
+  
+  string temp = string(fileName) + ".tmp";
+  int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if(fd < 0)
+    throw runtime_error("cannot open checkpoint file");
+  size_t written = 0;
+  while(written < buffer.size()) {
+    ssize_t k = write(fd, &buffer[written], buffer.size() - written);
+    if(k <= 0)
+      break;
+    written += k;
+  }
+  bool ok = written == buffer.size() && fsync(fd) == 0;
+  if(close(fd) != 0 || !ok || rename(temp.c_str(), fileName) != 0) {
+    remove(temp.c_str());
+    throw runtime_error("cannot write checkpoint file");
+  }
+}
+
+/**
+ * Destructor.  Stops the worker threads, if any.
+ */
+template <typename T>
+Life<T>::~Life() {
+  stopSnapshots();
+  stopPool();
+}
+
+/**
+ * Get the index of a cell in grid and next
+ * @param r the row of the cell, -1 to rows for the halo
+ * @param c the column of the cell, -1 to cols for the halo
+ * @return int the index of the cell.
+ */
+template <typename T>
+int Life<T>::index(int r, int c) const {
+  return (r + 1) * stride + c + 1;
+}
+
+/**
+ * Surround the rows * cols cells read into grid with a halo of dead cells
+ * one cell wide, so neighbors can be read without bounds checks.
+ */
+template <typename T>
+void Life<T>::pad() {
+  stride = cols + 2;
+  vector<T> padded((rows + 2) * stride, T());
+  for(int r = 0; r < rows; r++)
+    copy(grid.begin() + r * cols, grid.begin() + (r + 1) * cols, padded.begin() + index(r, 0));
+  grid.swap(padded);
+  next = grid;
+  bandCounts.assign(1, vector<int>(cols));
+}
+
+/**
+ * Fill the halo of grid for the boundary policy.  Dead halo cells are
+ * never written, so only a toroidal board has work to do: each halo cell
+ * becomes a copy of the cell on the opposite edge.
+ */
+template <typename T>
+void Life<T>::fillHalo() {
+  if(boundary != TOROIDAL)
+    return;
+  for(int r = 0; r < rows; r++) {
+    grid[index(r, -1)] = grid[index(r, cols - 1)];
+    grid[index(r, cols)] = grid[index(r, 0)];
+  }
+  copy(grid.begin() + index(rows - 1, -1), grid.begin() + index(rows - 1, cols + 1), grid.begin() + index(-1, -1));
+  copy(grid.begin() + index(0, -1), grid.begin() + index(0, cols + 1), grid.begin() + index(rows, -1));
+}
+
+/**
+ * Set how cells on the edges see past the edge.  DEAD boards see dead cells;
+ * TOROIDAL boards wrap around, so the top row neighbors the bottom row and
+ * the left column the right column.  The halos of both buffers are
+ * cleared, so no wrapped cells survive a switch back to DEAD.
+ * @param b the boundary policy
+ */
+template <typename T>
+void Life<T>::setBoundary(Boundary b) {
+  boundary = b;
+  vector<T>* boards[] = {&grid, &next};
+  for(int k = 0; k < 2; k++) {
+    vector<T>& board = *boards[k];
+    fill(board.begin(), board.begin() + index(0, -1), T());
+    fill(board.begin() + index(rows, -1), board.end(), T());
+    for(int r = 0; r < rows; r++)
+      board[index(r, -1)] = board[index(r, cols)] = T();
+  }
+  fillHalo();
+  if(incremental)
+    setIncremental(true);
+}
+
+/**
+ * Compare the cells, not the halos, of grid and another board
+ * @param other a board with the same layout as grid
+ * @return bool true if every cell equals the cell of other.
+ */
+template <typename T>
+bool Life<T>::sameBoard(const vector<T>& other) const {
+  for(int r = 0; r < rows; r++)
+    if(!equal(grid.begin() + index(r, 0), grid.begin() + index(r, cols), other.begin() + index(r, 0)))
+      return false;
+  return true;
+}
+
+/**
+ * Advance the board by one turn.  Reads the current generation from grid,
+ * writes the following one into next, then swaps the two.
+ */
+template <typename T>
+void Life<T>::takeTurn() {
+  fillHalo();
+  population = turnRows(0, rows, bandCounts[0]);
+  grid.swap(next);
+  generation++;
+  checkHash();
+#ifdef LIFE_STATS
+  recordStats();
+#endif
+}
+
+/**
+ * Advance the board by one turn, only re-evaluating the cells in active.
+ * A cell whose neighborhood did not change last turn cannot change this
+ * turn, so active holds the cells that changed and their neighbors.
+ * New states are collected first and applied after every active cell has
+ * been evaluated, and population is updated from the births and deaths.
+ */
+template <typename T>
+void Life<T>::takeTurnIncremental() {
+#ifdef LIFE_STATS
+  double start = now();
+#endif
+  fillHalo();
+  changedIndex.clear();
+  changedCells.clear();
+  for(unsigned int k = 0; k < active.size(); k++) {
+    int i = active[k];
+    T result = grid[i];
+    result.turn(countNeighbors(i));
+    if(!(result == grid[i])) {
+      changedIndex.push_back(i);
+      changedCells.push_back(result);
+    }
+    marked[i] = false;
+  }
+  active.clear();
+  
+#ifdef LIFE_STATS
+  stats.turnSeconds = now() - start;
+  stats.countSeconds = 0;
+  stats.births = stats.deaths = stats.promotions = 0;
+  for(unsigned int k = 0; k < changedIndex.size(); k++)
+    countChange(grid[changedIndex[k]], changedCells[k]);
+#endif
+  for(unsigned int k = 0; k < changedIndex.size(); k++) {
+    int i = changedIndex[k];
+    population -= (bool) grid[i];
+    grid[i] = changedCells[k];
+    population += (bool) grid[i];
+    for(int r = i / stride - 2; r <= i / stride; r++)
+      for(int c = i % stride - 2; c <= i % stride; c++)
+        markActive(r, c);
+  }
+  generation++;
+  checkHash();
+#ifdef LIFE_STATS
+  recordStats();
+#endif
+}
+
+/**
+ * Add a cell to the active set for the next incremental turn.
+ * @param r the row of the cell
+ * @param c the column of the cell.  Cells off the board are ignored, or
+ * wrap around on a toroidal board.
+ */
+template <typename T>
+void Life<T>::markActive(int r, int c) {
+  if(boundary == TOROIDAL) {
+    r = (r + rows) % rows;
+    c = (c + cols) % cols;
+  }
+  if(r < 0 || r >= rows || c < 0 || c >= cols)
+    return;
+  int i = index(r, c);
+  if(marked[i])
+    return;
+  marked[i] = true;
+  active.push_back(i);
+}
+
+/**
+ * Turn incremental stepping on or off.  When turned on every cell is
+ * evaluated on the first turn, since it is not known which ones changed.
+ * Incremental stepping runs on the calling thread only.
+ * @param on true to only re-evaluate cells near last turn's changes.
+ */
+template <typename T>
+void Life<T>::setIncremental(bool on) {
+  incremental = on;
+  active.clear();
+  marked.assign(on ? grid.size() : 0, false);
+  for(int r = 0; on && r < rows; r++)
+    for(int c = 0; c < cols; c++)
+      markActive(r, c);
+}
+
+/**
+ * Compute the next generation of a band of rows into next.
+ * Only reads grid, so disjoint bands can be computed concurrently.
+ * The neighbor counts of each row are all taken before any of its cells
+ * turn, so with LIFE_STATS the two phases can be timed; the band holding
+ * row 0 records the times.
+ * @param first the first row of the band
+ * @param last one past the last row of the band
+ * @param counts the band's buffer of cols neighbor counts
+ * @return int the population of the band in the next generation.
+ */
+template <typename T>
+int Life<T>::turnRows(int first, int last, vector<int>& counts) {
+  int bandPopulation = 0;
+#ifdef LIFE_STATS
+  bool timed = first == 0 && last > 0;
+  double start = timed ? now() : 0;
+  if(timed)
+    stats.countSeconds = stats.turnSeconds = 0;
+#endif
+  for(int i = first; i < last; i++) {
+    for(int j = 0; j < cols; j++)
+      counts[j] = countNeighbors(index(i, j));
+#ifdef LIFE_STATS
+    if(timed) {
+      double middle = now();
+      stats.countSeconds += middle - start;
+      start = middle;
+    }
+#endif
+    for(int j = 0; j < cols; j++) {
+      int k = index(i, j);
+      T& result = next[k];
+      result = grid[k];
+      result.turn(counts[j]);
+      if (result)
+        bandPopulation++;
+    }
+#ifdef LIFE_STATS
+    if(timed) {
+      double end = now();
+      stats.turnSeconds += end - start;
+      start = end;
+    }
+#endif
+  }
+  return bandPopulation;
+}
+
+/**
+ * Run the game the specified number of turns.  While snapshots are on,
+ * the turns are run in stretches that end on every multiple of the
+ * snapshot interval, and each of those generations is published.
+ * @param numTurns the number of turns to run for.
+ */
+template <typename T>
+void Life<T>::simulate(int numTurns) {
+  if(!snapshotOut) {
+    runTurns(numTurns);
+    return;
+  }
+  while(numTurns > 0) {
+    int turns = min(numTurns, snapshotEvery - generation % snapshotEvery);
+    runTurns(turns);
+    numTurns -= turns;
+    if(generation % snapshotEvery == 0)
+      publish();
+  }
+}
+
+/**
+ * Run the game the specified number of turns.  With cycle detection on the
+ * turns are run in stretches that end where the saved board is replaced,
+ * and once a repeat is found the remaining whole periods are skipped.
+ * @param numTurns the number of turns to run for.
+ */
+template <typename T>
+void Life<T>::runTurns(int numTurns) {
+  if(!detectCycles) {
+    advance(numTurns);
+    return;
+  }
+  while(numTurns > 0 && period == 0) {
+    int turns = min(numTurns, cycleGeneration + cycleLength - generation);
+    advance(turns);
+    numTurns -= turns;
+    findCycle();
+  }
+  if(period != 0) {
+    generation += numTurns - numTurns % period;
+    advance(numTurns % period);
+  }
+}
+
+/**
+ * Run the game the specified number of turns.  With more than one thread
+ * the rows are split into bands, one per thread, and the threads meet at a
+ * barrier after every generation.  The result is identical to the serial path.
+ * @param numTurns the number of turns to run for.
+ */
+template <typename T>
+void Life<T>::advance(int numTurns) {
+  if(incremental) {
+    while(numTurns-- > 0)
+      takeTurnIncremental();
+    return;
+  }
+  if(numThreads == 1 || numTurns <= 0) {
+    while(numTurns-- > 0)
+      takeTurn();
+    return;
+  }
+  
+  if(threads.empty())
+    startPool();
+  fillHalo();
+  pendingTurns = numTurns;
+  pthread_barrier_wait(&startBarrier);
+  runBand(0);
+}
+
+/**
+ * Turn cycle detection on or off.  Turning it on forgets any cycle found
+ * before, so turn it on again after changing cells through at().
+ * Every cell's state, Fredkin ages included, is part of the comparison,
+ * so boards whose ages keep growing are never taken for cycles.
+ * @param on true to look for a repeated board after every turn.
+ */
+template <typename T>
+void Life<T>::setCycleDetection(bool on) {
+  detectCycles = on;
+  period = 0;
+  transient = 0;
+  startGrid.clear();
+  cycleGrid.clear();
+  if(!on)
+    return;
+  startGrid = grid;
+  startGeneration = generation;
+  cycleGrid = grid;
+  cycleHash = hashGrid();
+  cycleGeneration = generation;
+  cycleLength = 1;
+  matchGeneration = 0;
+}
+
+/**
+ * Get the period of the cycle the board is in.
+ * @return int the period, 1 for a still life, or 0 if no cycle was found.
+ */
+template <typename T>
+int Life<T>::getPeriod() const {
+  return period;
+}
+
+/**
+ * Get the length of the transient before the cycle the board is in.  It
+ * is found the first time it is asked for, so runs that only need the
+ * period never pay for it.
+ * @return int the first generation of the cycle, or 0 if no cycle was found.
+ */
+template <typename T>
+int Life<T>::getTransient() {
+  if(period != 0 && !startGrid.empty())
+    findTransient();
+  return transient;
+}
+
+/**
+ * Hash the state of every cell of the current generation.
+ * @return uint64_t the FNV-1a hash of the cell kinds, aliveness and ages.
+ */
+template <typename T>
+uint64_t Life<T>::hashGrid() const {
+  const uint64_t prime = (uint64_t) 1 << 40 | 0x1b3;
+  uint64_t hash = (uint64_t) 0xcbf29ce4 << 32 | 0x84222325;
+  for(int i = 0; i < rows * cols; i++) {
+    CellState state = grid[index(i / cols, i % cols)].state();
+    hash ^= (uint64_t) state.kind | (uint64_t) state.alive << 1 | (uint64_t) state.age << 2;
+    hash *= prime;
+  }
+  return hash;
+}
+
+/**
+ * Note the first generation since the saved board that equals it.  Boards
+ * are only compared when their hashes match.  Called after every turn, so
+ * the search needs no turns of its own.
+ */
+template <typename T>
+void Life<T>::checkHash() {
+  if(detectCycles && period == 0 && matchGeneration == 0 && hashGrid() == cycleHash && sameBoard(cycleGrid))
+    matchGeneration = generation;
+}
+
+/**
+ * Load a board into a copy of this Life with the same boundary, number of
+ * threads and incremental mode, to replay generations the way they ran.
+ * @param copy a Life with the same number of rows and columns
+ * @param board a board with the same layout as grid
+ */
+template <typename T>
+void Life<T>::loadCopy(Life<T>& copy, const vector<T>& board) const {
+  copy.boundary = boundary;
+  copy.grid = board;
+  copy.setThreads(numThreads);
+  if(incremental)
+    copy.setIncremental(true);
+}
+
+/**
+ * Find the first generation of the cycle once its period is known, by
+ * running two copies of the board cycle detection started from, one period
+ * apart, until they are equal.  The copies run 64 turns at a time, and the
+ * last stretch is run again one turn at a time to find the exact generation.
+ */
+template <typename T>
+void Life<T>::findTransient() {
+  Life<T> first(rows, cols);
+  Life<T> second(rows, cols);
+  loadCopy(first, startGrid);
+  loadCopy(second, startGrid);
+  second.advance(period);
+  transient = startGeneration;
+  vector<T> firstStart;
+  vector<T> secondStart;
+  int turns = 64;
+  while(!first.sameBoard(second.grid)) {
+    firstStart = first.grid;
+    secondStart = second.grid;
+    first.advance(turns);
+    second.advance(turns);
+    if(turns > 1 && first.sameBoard(second.grid)) {
+      loadCopy(first, firstStart);
+      loadCopy(second, secondStart);
+      turns = 1;
+    }
+    else
+      transient += turns;
+  }
+  startGrid.clear();
+}
+
+/**
+ * Check whether the board repeated an earlier generation, using Brent's
+ * algorithm: the board is compared with a saved generation, which is
+ * replaced whenever the distance to it reaches the next power of 2.
+ * checkHash() notes the first repeat after each turn, so once one is found
+ * the period is the distance to the saved generation.
+ */
+template <typename T>
+void Life<T>::findCycle() {
+  if(matchGeneration != 0) {
+    period = matchGeneration - cycleGeneration;
+    cycleGrid.clear();
+    return;
+  }
+  if(generation - cycleGeneration == cycleLength) {
+    cycleGrid = grid;
+    cycleHash = hashGrid();
+    cycleGeneration = generation;
+    cycleLength *= 2;
+  }
+}
+
+#ifdef LIFE_STATS
+/**
+ * Get the wall clock time
+ * @return double the seconds since the epoch.
+ */
+template <typename T>
+double Life<T>::now() {
+  timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec + t.tv_usec / 1e6;
+}
+
+/**
+ * Add one cell's change to the births, deaths and promotions of stats.
+ * @param before the cell in the previous generation
+ * @param after the cell in the current generation
+ */
+template <typename T>
+void Life<T>::countChange(const T& before, const T& after) {
+  CellState from = before.state();
+  CellState to = after.state();
+  stats.births += !from.alive && to.alive;
+  stats.deaths += from.alive && !to.alive;
+  stats.promotions += from.kind == CellState::FREDKIN && to.kind == CellState::CONWAY;
+}
+
+/**
+ * Finish the stats of the generation just computed, pass them to the
+ * callback and put them in the ring.  The whole board paths count births
+ * and deaths by comparing grid with next, which holds the previous
+ * generation after the swap; the incremental path counts them from its
+ * changed cells before calling this.  When the ring is full the stats are
+ * dropped rather than overwriting ones drainStats() has not read.
+ */
+template <typename T>
+void Life<T>::recordStats() {
+  if(!incremental) {
+    stats.births = stats.deaths = stats.promotions = 0;
+    for(int r = 0; r < rows; r++)
+      for(int c = 0; c < cols; c++)
+        countChange(next[index(r, c)], grid[index(r, c)]);
+  }
+  stats.generation = generation;
+  stats.population = population;
+  if(statsCallback)
+    statsCallback(stats, statsContext);
+  if(statsHead - statsTail == LIFE_STATS_RING) {
+    statsDropped++;
+    return;
+  }
+  statsRing[statsHead % LIFE_STATS_RING] = stats;
+  __sync_synchronize();
+  statsHead = statsHead + 1;
+}
+
+/**
+ * Set a function to call with the stats of every generation.  It is called
+ * on the thread that computed the generation, so it should be quick.
+ * @param callback the function to call, or 0 for none
+ * @param context passed through to callback
+ */
+template <typename T>
+void Life<T>::setStatsCallback(StatsCallback callback, void* context) {
+  statsCallback = callback;
+  statsContext = context;
+}
+
+/**
+ * Move the stats in the ring to out.  Safe to call from one other thread
+ * while simulate() runs.
+ * @param out the vector to append the stats to, oldest first
+ * @return int the number of stats appended.
+ */
+template <typename T>
+int Life<T>::drainStats(vector<GenerationStats>& out) {
+  unsigned int head = statsHead;
+  __sync_synchronize();
+  int drained = 0;
+  for(unsigned int i = statsTail; i != head; i++, drained++)
+    out.push_back(statsRing[i % LIFE_STATS_RING]);
+  __sync_synchronize();
+  statsTail = head;
+  return drained;
+}
+
+/**
+ * Get the number of generations whose stats did not fit in the ring.
+ * @return unsigned int the number of stats dropped.
+ */
+template <typename T>
+unsigned int Life<T>::droppedStats() const {
+  return statsDropped;
+}
+#endif
+
+/**
+ * Set the number of threads simulate() uses.  The worker threads are
+ * started on the next simulate() and kept until the thread count changes.
+ * @param n the number of threads, including the calling thread.
+ */
+template <typename T>
+void Life<T>::setThreads(int n) {
+  if(n < 1)
+    throw invalid_argument("n must be at least 1");
+  if(n == numThreads)
+    return;
+  stopPool();
+  numThreads = n;
+}
+
+/**
+ * Advance one band of rows pendingTurns generations, in step with the other bands.
+ * After each generation the one thread the barrier picks swaps the buffers.
+ * @param band the index of the band to compute
+ */
+template <typename T>
+void Life<T>::runBand(int band) {
+  int first = rows * band / numThreads;
+  int last = rows * (band + 1) / numThreads;
+  int turns = pendingTurns;
+  for(int t = 0; t < turns; t++) {
+    bandPopulation[band] = turnRows(first, last, bandCounts[band]);
+    if(pthread_barrier_wait(&turnBarrier) == PTHREAD_BARRIER_SERIAL_THREAD) {
+      population = 0;
+      for(int b = 0; b < numThreads; b++)
+        population += bandPopulation[b];
+      grid.swap(next);
+      generation++;
+      fillHalo();
+      checkHash();
+#ifdef LIFE_STATS
+      recordStats();
+#endif
+    }
+    pthread_barrier_wait(&turnBarrier);
+  }
+}
+
+/**
+ * Start numThreads - 1 worker threads.  The calling thread computes band 0.
+ * The workers wait on poolLock until every thread has been created, so if
+ * one cannot be, the others are told to stop before they reach the barrier.
+ */
+template <typename T>
+void Life<T>::startPool() {
+  stopping = false;
+  bandPopulation.assign(numThreads, 0);
+  bandCounts.assign(numThreads, vector<int>(cols));
+  workers.resize(numThreads);
+  if(pthread_barrier_init(&startBarrier, 0, numThreads) != 0)
+    throw runtime_error("cannot create barrier");
+  if(pthread_barrier_init(&turnBarrier, 0, numThreads) != 0) {
+    pthread_barrier_destroy(&startBarrier);
+    throw runtime_error("cannot create barrier");
+  }
+  pthread_mutex_init(&poolLock, 0);
+  pthread_mutex_lock(&poolLock);
+  for(int b = 1; b < numThreads && !stopping; b++) {
+    workers[b].life = this;
+    workers[b].band = b;
+    pthread_t thread;
+    if(pthread_create(&thread, 0, work, &workers[b]) != 0)
+      stopping = true;
+    else
+      threads.push_back(thread);
+  }
+  pthread_mutex_unlock(&poolLock);
+  if(!stopping)
+    return;
+  for(unsigned int i = 0; i < threads.size(); i++)
+    pthread_join(threads[i], 0);
+  threads.clear();
+  pthread_mutex_destroy(&poolLock);
+  pthread_barrier_destroy(&startBarrier);
+  pthread_barrier_destroy(&turnBarrier);
+  throw runtime_error("cannot create worker thread");
+}
+
+/**
+ * Stop and join the worker threads, if any.
+ */
+template <typename T>
+void Life<T>::stopPool() {
+  if(threads.empty())
+    return;
+  stopping = true;
+  pthread_barrier_wait(&startBarrier);
+  for(unsigned int i = 0; i < threads.size(); i++)
+    pthread_join(threads[i], 0);
+  threads.clear();
+  pthread_mutex_destroy(&poolLock);
+  pthread_barrier_destroy(&startBarrier);
+  pthread_barrier_destroy(&turnBarrier);
+}
+
+/**
+ * Worker thread body.  Waits for simulate() to start, then runs its band.
+ * @param arg the Worker describing the band to run
+ * @return 0
+ */
+template <typename T>
+void* Life<T>::work(void* arg) {
+  Worker* worker = static_cast<Worker*>(arg);
+  Life* life = worker->life;
+  pthread_mutex_lock(&life->poolLock);
+  bool stopped = life->stopping;
+  pthread_mutex_unlock(&life->poolLock);
+  if(stopped)
+    return 0;
+  while(true) {
+    pthread_barrier_wait(&life->startBarrier);
+    if(life->stopping)
+      return 0;
+    life->runBand(worker->band);
+  }
+}
+
+/**
+ * Print out the current state of the game.  Each row is built in a buffer
+ * and written with one call, and the stream is not flushed.
+ * @param out the ostream& to print out to.
+ */
+template <typename T>
+void Life<T>::print(ostream& out) {
+  writeBoard(out, generation, population, grid);
+}
+
+/**
+ * Print only the cells that changed since the last printDelta().  The first
+ * call prints every cell.  After the header, each line is a row, a column
+ * and the new names of the run of changed cells starting there, with
+ * repeats written as a bracketed count before the name, e.g. "4 7 [3]*.[2]-".
+ * The delta ends with an empty line.
+ * @param out the ostream& to print out to.
+ */
+template <typename T>
+void Life<T>::printDelta(ostream& out) {
+  writeDelta(out, generation, population, grid, snapshot);
+}
+
+/**
+ * Write a board in the format of print()
+ * @param out the ostream& to write to
+ * @param gen the generation of the board
+ * @param pop the population of the board
+ * @param cells the board, laid out like grid
+ */
+template <typename T>
+void Life<T>::writeBoard(ostream& out, int gen, int pop, const vector<T>& cells) const {
+  out << "Generation = " << gen << ", Population = " << pop << ".\n";
+  string line(cols + 1, '\n');
+  for(int i = 0; i < rows; i++) {
+    for(int j = 0; j < cols; j++)
+      line[j] = cells[index(i, j)].name();
+    out.write(line.data(), line.size());
+  }
+  out << '\n';
+}
+
+/**
+ * Write the changes to a board in the format of printDelta()
+ * @param out the ostream& to write to
+ * @param gen the generation of the board
+ * @param pop the population of the board
+ * @param cells the board, laid out like grid
+ * @param last the names of the cells as last written, updated to cells
+ */
+template <typename T>
+void Life<T>::writeDelta(ostream& out, int gen, int pop, const vector<T>& cells, vector<char>& last) const {
+  last.resize(rows * cols, 0);
+  ostringstream body;
+  int changes = 0;
+  for(int i = 0; i < rows; i++) {
+    int j = 0;
+    while(j < cols) {
+      if(cells[index(i, j)].name() == last[i * cols + j]) {
+        j++;
+        continue;
+      }
+      body << i << ' ' << j << ' ';
+      while(j < cols) {
+        char cell = cells[index(i, j)].name();
+        if(cell == last[i * cols + j])
+          break;
+        int count = 0;
+        while(j < cols && cells[index(i, j)].name() == cell && cell != last[i * cols + j]) {
+          last[i * cols + j] = cell;
+          count++;
+          j++;
+        }
+        if(count > 1)
+          body << '[' << count << ']';
+        body << cell;
+        changes += count;
+      }
+      body << '\n';
+    }
+  }
+  out << "Generation = " << gen << ", Population = " << pop << ", Changes = " << changes << ".\n";
+  out << body.str() << '\n';
+}
+
+/**
+ * Start writing snapshots on a background thread.  From now on simulate()
+ * copies the board into a snapshot buffer every time the generation
+ * reaches a multiple of every, and the writer thread formats and writes it
+ * while the following generations are computed.  There are depth buffers;
+ * when all of them are waiting to be written, simulate() waits for one.
+ * Nothing else may use out until stopSnapshots().
+ * @param out the ostream& to write the snapshots to
+ * @param every the number of generations between snapshots
+ * @param depth the number of snapshots that can wait to be written
+ * @param format FULL for the format of print(), DELTA for printDelta()
+ */
+template <typename T>
+void Life<T>::startSnapshots(ostream& out, int every, int depth, SnapshotFormat format) {
+  if(every < 1 || depth < 1)
+    throw invalid_argument("every and depth must be at least 1");
+  stopSnapshots();
+  snapshotOut = &out;
+  snapshotEvery = every;
+  snapshotFormat = format;
+  snapshots.assign(depth, Snapshot());
+  freeSnapshots.clear();
+  for(int i = 0; i < depth; i++)
+    freeSnapshots.push_back(i);
+  queuedSnapshots.clear();
+  writtenNames.clear();
+  writerStopping = false;
+  pthread_mutex_init(&snapshotLock, 0);
+  pthread_cond_init(&snapshotFree, 0);
+  pthread_cond_init(&snapshotQueued, 0);
+  if(pthread_create(&writer, 0, writeSnapshots, this) != 0) {
+    pthread_mutex_destroy(&snapshotLock);
+    pthread_cond_destroy(&snapshotFree);
+    pthread_cond_destroy(&snapshotQueued);
+    snapshotOut = 0;
+    snapshots.clear();
+    throw runtime_error("cannot create snapshot writer thread");
+  }
+}
+
+/**
+ * Write the snapshots still waiting, flush the stream and stop the writer thread.
+ */
+template <typename T>
+void Life<T>::stopSnapshots() {
+  if(!snapshotOut)
+    return;
+  pthread_mutex_lock(&snapshotLock);
+  writerStopping = true;
+  pthread_cond_signal(&snapshotQueued);
+  pthread_mutex_unlock(&snapshotLock);
+  pthread_join(writer, 0);
+  pthread_mutex_destroy(&snapshotLock);
+  pthread_cond_destroy(&snapshotFree);
+  pthread_cond_destroy(&snapshotQueued);
+  snapshotOut->flush();
+  snapshotOut = 0;
+  snapshots.clear();
+}
+
+/**
+ * Copy the current generation into a free snapshot buffer and queue it for
+ * the writer, waiting for a buffer if all of them are queued.  The copy
+ * reuses the buffer's cells, so it does not allocate after the first lap.
+ */
+template <typename T>
+void Life<T>::publish() {
+  pthread_mutex_lock(&snapshotLock);
+  while(freeSnapshots.empty())
+    pthread_cond_wait(&snapshotFree, &snapshotLock);
+  int i = freeSnapshots.back();
+  freeSnapshots.pop_back();
+  pthread_mutex_unlock(&snapshotLock);
+  
+  snapshots[i].generation = generation;
+  snapshots[i].population = population;
+  snapshots[i].cells.assign(grid.begin(), grid.end());
+  
+  pthread_mutex_lock(&snapshotLock);
+  queuedSnapshots.push_back(i);
+  pthread_cond_signal(&snapshotQueued);
+  pthread_mutex_unlock(&snapshotLock);
+}
+
+/**
+ * Writer thread body.  Writes queued snapshots in order and returns their
+ * buffers, until stopSnapshots() is called and the queue is empty.
+ * @param arg the Life whose snapshots to write
+ * @return 0
+ */
+template <typename T>
+void* Life<T>::writeSnapshots(void* arg) {
+  Life* life = static_cast<Life*>(arg);
+  while(true) {
+    pthread_mutex_lock(&life->snapshotLock);
+    while(life->queuedSnapshots.empty() && !life->writerStopping)
+      pthread_cond_wait(&life->snapshotQueued, &life->snapshotLock);
+    if(life->queuedSnapshots.empty()) {
+      pthread_mutex_unlock(&life->snapshotLock);
+      return 0;
+    }
+    int i = life->queuedSnapshots.front();
+    life->queuedSnapshots.erase(life->queuedSnapshots.begin());
+    pthread_mutex_unlock(&life->snapshotLock);
+    
+    const Snapshot& s = life->snapshots[i];
+    if(life->snapshotFormat == FULL)
+      life->writeBoard(*life->snapshotOut, s.generation, s.population, s.cells);
+    else
+      life->writeDelta(*life->snapshotOut, s.generation, s.population, s.cells, life->writtenNames);
+    
+    pthread_mutex_lock(&life->snapshotLock);
+    life->freeSnapshots.push_back(i);
+    pthread_cond_signal(&life->snapshotFree);
+    pthread_mutex_unlock(&life->snapshotLock);
+  }
+}
+
+/**
+ * Get the cell at the specified grid location
+ * @param r the row of the cell
+ * @param c the column of the cell
+ * @return T& reference to the cell in the current generation.
+ */
+template <typename T>
+T& Life<T>::at(int r, int c) {
+  return grid[index(r, c)];
+}
+
+/**
+ * Count the number of alive neighbors of the specified cell.
+ * @param r the row of the cell to count the neighbors of
+ * @param c the column of the cell to count the neighbors of
+ * @return int the number of alive neighbors.
+ */
+template <typename T>
+int Life<T>::countNeighbors(int r, int c) {
+  fillHalo();
+  return countNeighbors(index(r, c));
+}
+
+/**
+ * Count the number of alive neighbors of the cell at an index of grid.
+ * The halo holds the cells past the edges, so there are no bounds checks;
+ * each neighbor Position is an index delta of r * stride + c.
+ * @param i the index of the cell, which must not be in the halo
+ * @return int the number of alive neighbors.
+ */
+template <typename T>
+int Life<T>::countNeighbors(int i) {
+  const vector<Position>& adjacent = grid[i].neighbors();
+  T* cell = &grid[i];
+  int numNeighbors = 0;
+  for(unsigned int k = 0; k < adjacent.size(); k++)
+    numNeighbors += (bool) cell[adjacent[k].r * stride + adjacent[k].c];
+  return numNeighbors;
+}
+
+/**
+ * see if the specified cell is alive
+ * @param p a Position specifying the grid location of the cell to check.
+ * @return bool representing if the cell is alive or not.  Cells off the board
+ * are dead, or wrap around on a toroidal board.
+ */
+template <typename T>
+bool Life<T>::isAlive(Position p) {
+  if(boundary == TOROIDAL) {
+    p.r = (p.r % rows + rows) % rows;
+    p.c = (p.c % cols + cols) % cols;
+  }
+  if(p.r < 0 || p.r >= rows || p.c < 0 || p.c >= cols) 
+    return false;
+  return grid[index(p.r, p.c)];
+}
+
+// -------------
+// Abstract Cell
+// -------------
+
+/**
+ * Conversion to bool representing the aliveness of the cell.
+ * @return bool representing whether the cell is alive or not
+ */
+AbstractCell::operator bool() {
+  return alive;
+}
+
+/**
+ * Conversion to int representing the age of the cell.  Defaults to 0.
+ * @return 0
+ */
+AbstractCell::operator int() {
+  return 0;
+}
+
+// ----
+// Cell
+// ----
+
+/**
+ * Default constructor for Cell.  Creates a dead Conway cell.
+ */
+Cell::Cell() {
+  kind = CONWAY;
+  alive = false;
+  age = 0;
+}
+
+/**
+ * char constructor for Cell.  Creates a Conway or Fredkin cell depending on input.
+ * @param c char representing the type and state of the cell to be created.
+ */
+Cell::Cell(char c){
+  age = 0;
+  if(c == '.'|| c == '*') {
+    kind = CONWAY;
+    alive = (c == '*');
+  }
+  else {
+    kind = FREDKIN;
+    alive = (c != '-');
+    if(alive)
+      age = c & 0xF;
+  }
+}
+
+/**
+ * CellState constructor for Cell, used to restore checkpoints.
+ * @param state the kind, aliveness and age of the cell
+ */
+Cell::Cell(const CellState& state) {
+  kind = state.kind == CellState::FREDKIN ? FREDKIN : CONWAY;
+  alive = state.alive;
+  age = state.age;
+}
+
+/**
+ * Get the state of the Cell, used to write checkpoints.
+ * @return CellState with the kind, aliveness and age of the cell.
+ */
+CellState Cell::state() const {
+  CellState result;
+  result.kind = kind == FREDKIN ? CellState::FREDKIN : CellState::CONWAY;
+  result.alive = alive;
+  result.age = age;
+  return result;
+}
+
+/**
+ * Advance the state of the Cell by one turn.  Follows the ConwayCell or
+ * FredkinCell rule, and a Fredkin cell that reaches age 2 alive becomes an
+ * alive Conway cell.
+ * @param numNeighbors the number of alive neighbors of the Cell
+ */
+void Cell::turn(int numNeighbors) {
+  if(kind == CONWAY) {
+    if (numNeighbors == 3)
+      alive = true;
+    else if (numNeighbors < 2 || numNeighbors > 3)
+      alive = false;
+    return;
+  }
+  
+  if (numNeighbors % 2 == 1) {
+    if(alive)
+      age++;
+    alive = true;
+  }
+  else
+    alive = false;
+  
+  if(age == 2 && alive) {
+    kind = CONWAY;
+    age = 0;
+  }
+}
+
+/**
+ * Get a Position vector representing the Positions to consider as neighbors.
+ * @return const vector<Position>& representing the relative Positions to consider as neighbors.
+ */
 const vector<Position>& Cell::neighbors() const {
-  return ptr->neighbors();
+  if(kind == CONWAY)
+    return conwayNeighbors;
+  return fredkinNeighbors;
+}
+
+/**
+ * Get the character representing the current state of the Cell
+ * @return char representing the state of the cell
+ */
+char Cell::name() const {
+  if(kind == CONWAY)
+    return alive ? '*' : '.';
+  if(!alive)
+    return '-';
+  if(age > 9)
+    return '+';
+  return (char) (age + 0x30);
+}
+
+/**
+ * Equality of state
+ * @param other the Cell to compare to
+ * @return true if both cells have the same kind, aliveness and age.
+ */
+bool Cell::operator == (const Cell& other) const {
+  return kind == other.kind && alive == other.alive && age == other.age;
+}
+
+/**
+ * Conversion to bool
+ * @return bool representing whether the cell is alive or not
+ */
+Cell::operator bool(){
+  return alive;
+}
+
+/**
+ * Conversion to int
+ * @return the age of a Fredkin cell, 0 for a Conway cell.
+ */
+Cell::operator int() {
+  return age;
+}
+
+// -----------
+// Conway Cell
+// -----------
+
+/**
+ * Default constructor for ConwayCell.  Creates a dead cell.
+ */
+ConwayCell::ConwayCell() {
+  alive = false;
+}
+
+/**
+ * char constructor for ConwayCell
+ * @param char representing the initial state of the cell.
+ */
+ConwayCell::ConwayCell(char c) {
+  if (c == '.')
+    alive = false;
+  else if (c == '*')
+    alive = true;
+}
+
+/**
+ * CellState constructor for ConwayCell, used to restore checkpoints.
+ * @param state the state of the cell.  Only the aliveness is used.
+ */
+ConwayCell::ConwayCell(const CellState& state) {
+  alive = state.alive;
+}
+
+/**
+ * Get the state of the cell, used to write checkpoints.
+ * @return CellState of a Conway cell with age 0.
+ */
+CellState ConwayCell::state() const {
+  CellState result;
+  result.kind = CellState::CONWAY;
+  result.alive = alive;
+  result.age = 0;
+  return result;
+}
+
+/**
+ * Advance the cell state by one turn.
+ * @param numNeighbors the number of alive neighbors of the cell
+ */
+void ConwayCell::turn(int numNeighbors) {
+  if (numNeighbors == 3)
+    alive = true;
+  else if (numNeighbors < 2 || numNeighbors > 3)
+    alive = false;
+  else
+    alive = alive; //do nothing
+}
+
+/**
+ * Get a Position vector representing the Positions to consider as neighbors.
+ * @return const vector<Position>& representing the relative Positions to consider as neighbors.
+ */
+const vector<Position>& ConwayCell::neighbors() const {
+  return conwayNeighbors;
+}
+
+/**
+ * Get the character representing the current state of the Cell
+ * @return char representing the state of the cell
+ */
+char ConwayCell::name() const {
+  if(alive)
+    return '*';
+  return '.';
+}
+
+/**
+ * Equality of state
+ * @param other the ConwayCell to compare to
+ * @return true if both cells are alive or both are dead.
+ */
+bool ConwayCell::operator == (const ConwayCell& other) const {
+  return alive == other.alive;
+}
+
+/**
+ * Create a clone of the cell
+ * @return pointer to the new cell.
+ */
+AbstractCell* ConwayCell::clone() const {
+  return new ConwayCell(*this);
+}
+
+
+// ------------
+// Fredkin Cell
+// ------------
+
+/**
+ * Default constructor for FredkinCell.  Creates a dead cell.
+ */
+FredkinCell::FredkinCell() {
+  alive = false;
+  age = 0;
+}
+
+/**
+ * char constructor for FredkinCell
+ * @param char representing the initial state of the cell.
+ */
+FredkinCell::FredkinCell(char c) {
+  age = 0;
+  if (c == '-')
+    alive = false;
+  else {
+    alive = true;
+    age = c & 0xF;
+  } 
+}
+
+/**
+ * CellState constructor for FredkinCell, used to restore checkpoints.
+ * @param state the state of the cell.  The aliveness and age are used.
+ */
+FredkinCell::FredkinCell(const CellState& state) {
+  alive = state.alive;
+  age = state.age;
+}
+
+/**
+ * Get the state of the cell, used to write checkpoints.
+ * @return CellState of a Fredkin cell with its exact age.
+ */
+CellState FredkinCell::state() const {
+  CellState result;
+  result.kind = CellState::FREDKIN;
+  result.alive = alive;
+  result.age = age;
+  return result;
+}
+
+/**
+ * Advance the cell state by one turn.
+ * @param numNeighbors the number of alive neighbors of the cell
+ */
+void FredkinCell::turn(int numNeighbors) {
+  if (numNeighbors % 2 == 1) {
+    if(alive)
+      age++;
+    alive = true;
+  }
+  else
+    alive = false;
+}
+
+/**
+ * Get a Position vector representing the Positions to consider as neighbors.
+ * @return const vector<Position>& representing the relative Positions to consider as neighbors.
+ */
+const vector<Position>& FredkinCell::neighbors() const {
+  return fredkinNeighbors;
+}
+
+/**
+ * Get the character representing the current state of the Cell
+ * @return char representing the state of the cell
+ */
+char FredkinCell::name() const {
+  if(!alive)
+    return '-';
+  if(age > 9)
+    return '+';
+  return (char) (age + 0x30);
+}
+
+/**
+ * Equality of state
+ * @param other the FredkinCell to compare to
+ * @return true if both cells have the same aliveness and age.
+ */
+bool FredkinCell::operator == (const FredkinCell& other) const {
+  return alive == other.alive && age == other.age;
+}
+
+/**
+ * Conversion to int.
+ * @return the age of the cell.
+ */
+FredkinCell::operator int() {
+  return age;
+}
+
+/**
+ * Create a clone of the cell
+ * @return pointer to the new cell.
+ */
+AbstractCell* FredkinCell::clone() const {
+  return new FredkinCell(*this);
+}
+
+
+// -------
+// BitLife
+// -------
+
+/**
+ * Count the set bits in a word.
+ * @param x the word to count
+ * @return the number of bits set in x
+ */
+inline int popCount(uint64_t x) {
+  const uint64_t ones = ~(uint64_t) 0;
+  x = x - ((x >> 1) & (ones / 3));
+  x = (x & (ones / 5)) + ((x >> 2) & (ones / 5));
+  x = (x + (x >> 4)) & (ones / 17);
+  return (int) ((x * (ones / 255)) >> 56);
+}
+
+/**
+ * Add three bit vectors lane by lane.
+ * @param a first addend
+ * @param b second addend
+ * @param c third addend
+ * @param sum set to the ones bit of each lane
+ * @param carry set to the twos bit of each lane
+ */
+inline void fullAdd(uint64_t a, uint64_t b, uint64_t c, uint64_t& sum, uint64_t& carry) {
+  uint64_t t = a ^ b;
+  sum = t ^ c;
+  carry = (a & b) | (t & c);
+}
+
+/**
+ * Apply the Conway rule to 64 cells at once.  Each argument holds one
+ * neighbor (or the cell itself) of every cell, already shifted into place.
+ * @param aw north west neighbors
+ * @param a north neighbors
+ * @param ae north east neighbors
+ * @param mw west neighbors
+ * @param m the cells
+ * @param me east neighbors
+ * @param bw south west neighbors
+ * @param b south neighbors
+ * @param be south east neighbors
+ * @return uint64_t the cells one generation later.
+ */
+inline uint64_t conwayWord(uint64_t aw, uint64_t a, uint64_t ae,
+                           uint64_t mw, uint64_t m, uint64_t me,
+                           uint64_t bw, uint64_t b, uint64_t be) {
+  uint64_t a0, a1, b0, b1, s0, c1, t, u;
+  fullAdd(aw, a, ae, a0, a1);
+  fullAdd(bw, b, be, b0, b1);
+  uint64_t m0 = mw ^ me;
+  uint64_t m1 = mw & me;
+  
+  fullAdd(a0, b0, m0, s0, c1);
+  fullAdd(a1, b1, m1, t, u);
+  uint64_t s1 = t ^ c1;
+  uint64_t s2 = u ^ (t & c1);
+  
+  // exactly 3 neighbors, or exactly 2 and already alive
+  return s1 & ~s2 & (s0 | m);
+}
+
+/**
+ * istream& BitLife Constructor.  Reads the same format as Life<ConwayCell>.
+ * Cell (r, c) is stored in bit c % 64 of word c / 64 of row r.
+ * @param in the istream& to read input from
+ */
+BitLife::BitLife(istream& in) {
+  generation = 0;
+  population = 0;
+  in >> rows;
+  in >> cols >> ws;
+  wordsPerRow = (cols + 63) / 64;
+  lastMask = (cols % 64 == 0) ? ~(uint64_t) 0 : (((uint64_t) 1 << (cols % 64)) - 1);
+  grid.assign(rows * wordsPerRow, 0);
+  next.assign(rows * wordsPerRow, 0);
+  
+  for(int r = 0; r < rows; r++) {
+    for(int c = 0; c < cols; c++) {
+      char cell;
+      in >> cell;
+      if(cell == '*') {
+        grid[r * wordsPerRow + c / 64] |= (uint64_t) 1 << (c % 64);
+        population++;
+      }
+    }
+    if(in)
+      in >> ws;
+  }
+}
+
+/**
+ * Advance the board by one turn.  The eight neighbor bits of 64 cells are
+ * summed at once with full adders; cells outside the board are dead.
+ */
+void BitLife::takeTurn() {
+  population = 0;
+  const uint64_t zero = 0;
+  for(int r = 0; r < rows; r++) {
+    const uint64_t* above = (r > 0) ? &grid[(r - 1) * wordsPerRow] : 0;
+    const uint64_t* row = &grid[r * wordsPerRow];
+    const uint64_t* below = (r < rows - 1) ? &grid[(r + 1) * wordsPerRow] : 0;
+    uint64_t* out = &next[r * wordsPerRow];
+    
+    for(int w = 0; w < wordsPerRow; w++) {
+      bool first = (w == 0);
+      bool last = (w == wordsPerRow - 1);
+      
+      uint64_t a = above ? above[w] : zero;
+      uint64_t aw = (a << 1) | (above && !first ? above[w - 1] >> 63 : zero);
+      uint64_t ae = (a >> 1) | (above && !last ? above[w + 1] << 63 : zero);
+      
+      uint64_t m = row[w];
+      uint64_t mw = (m << 1) | (!first ? row[w - 1] >> 63 : zero);
+      uint64_t me = (m >> 1) | (!last ? row[w + 1] << 63 : zero);
+      
+      uint64_t b = below ? below[w] : zero;
+      uint64_t bw = (b << 1) | (below && !first ? below[w - 1] >> 63 : zero);
+      uint64_t be = (b >> 1) | (below && !last ? below[w + 1] << 63 : zero);
+      
+      uint64_t cell = conwayWord(aw, a, ae, mw, m, me, bw, b, be);
+      if(last)
+        cell &= lastMask;
+      out[w] = cell;
+      population += popCount(cell);
+    }
+  }
+  grid.swap(next);
+  generation++;
+}
+
+/**
+ * Run the game the specified number of turns
+ * @param numTurns the number of turns to run for.
+ */
+void BitLife::simulate(int numTurns) {
+  while(numTurns-- > 0)
+    takeTurn();
+}
+
+/**
+ * Print out the current state of the game in the same format as Life<ConwayCell>
+ * @param out the ostream& to print out to.
+ */
+void BitLife::print(ostream& out) {
+  out << "Generation = " << generation << ", Population = " << population << ".\n";
+  string line(cols + 1, '\n');
+  for(int r = 0; r < rows; r++) {
+    for(int c = 0; c < cols; c++)
+      line[c] = isAlive(r, c) ? '*' : '.';
+    out.write(line.data(), line.size());
+  }
+  out << '\n';
+}
+
+/**
+ * see if the specified cell is alive
+ * @param r the row of the cell
+ * @param c the column of the cell
+ * @return bool representing if the cell is alive or not.  Cells off the board are dead.
+ */
+bool BitLife::isAlive(int r, int c) const {
+  if(r < 0 || r >= rows || c < 0 || c >= cols)
+    return false;
+  return (grid[r * wordsPerRow + c / 64] >> (c % 64)) & 1;
+}
+
+// --------
+// HashLife
+// --------
+
+/**
+ * istream& HashLife Constructor.  Reads the same format as Life<ConwayCell>.
+ * The board is stored in a quadtree whose nodes are shared by content.
+ * Everything outside the board is WALL, a third state that is never alive
+ * and never changes, which gives the same fixed dead edges as Life<T>.
+ * @param in the istream& to read input from
+ * @param maxNodes the node count above which unreachable nodes are freed,
+ * checked whenever a successor is computed
+ */
+HashLife::HashLife(istream& in, int maxNodes) : maxNodes(maxNodes) {
+  generation = 0;
+  population = 0;
+  nodeCount = 0;
+  peakCount = 0;
+  collectAt = maxNodes;
+  top = 0;
+  left = 0;
+  buckets.assign(1 << 10, (Node*) 0);
+  for(int i = 0; i < 3; i++) {
+    Node* leaf = new Node();
+    leaf->level = 0;
+    leaf->resultStep = -1;
+    leaf->state = (State) i;
+    leaf->population = (i == ALIVE);
+    leaves[i] = leaf;
+  }
+  walls.push_back(leaves[WALL]);
+  
+  in >> rows;
+  in >> cols >> ws;
+  vector<State> cells(rows * cols, DEAD);
+  for(int r = 0; r < rows; r++) {
+    for(int c = 0; c < cols; c++) {
+      char cell;
+      in >> cell;
+      if(cell == '*')
+        cells[r * cols + c] = ALIVE;
+    }
+    if(in)
+      in >> ws;
+  }
+  
+  int level = 2;
+  while((1 << level) < rows || (1 << level) < cols)
+    level++;
+  root = build(cells, level, 0, 0);
+  population = root->population;
+}
+
+/**
+ * Destructor.  Deletes every node.
+ */
+HashLife::~HashLife() {
+  for(unsigned int i = 0; i < buckets.size(); i++)
+    while(buckets[i]) {
+      Node* node = buckets[i];
+      buckets[i] = node->chain;
+      delete node;
+    }
+  for(int i = 0; i < 3; i++)
+    delete leaves[i];
+}
+
+/**
+ * Get the unique node with the given quadrants, creating it if needed.
+ * @param nw the north west quadrant
+ * @param ne the north east quadrant
+ * @param sw the south west quadrant
+ * @param se the south east quadrant
+ * @return Node* the node one level above its quadrants.
+ */
+HashLife::Node* HashLife::join(Node* nw, Node* ne, Node* sw, Node* se) {
+  uintptr_t h = (uintptr_t) nw;
+  h = h * 31 + (uintptr_t) ne;
+  h = h * 31 + (uintptr_t) sw;
+  h = h * 31 + (uintptr_t) se;
+  h ^= h >> 15;
+  unsigned int b = h & (buckets.size() - 1);
+  for(Node* node = buckets[b]; node; node = node->chain)
+    if(node->nw == nw && node->ne == ne && node->sw == sw && node->se == se)
+      return node;
+  
+  Node* node = new Node();
+  node->nw = nw;
+  node->ne = ne;
+  node->sw = sw;
+  node->se = se;
+  node->level = nw->level + 1;
+  node->resultStep = -1;
+  node->population = nw->population + ne->population + sw->population + se->population;
+  node->chain = buckets[b];
+  buckets[b] = node;
+  
+  if(++nodeCount > peakCount)
+    peakCount = nodeCount;
+  if(nodeCount > (int) buckets.size()) {
+    vector<Node*> old(buckets.size() * 2, (Node*) 0);
+    old.swap(buckets);
+    for(unsigned int i = 0; i < old.size(); i++)
+      while(old[i]) {
+        Node* n = old[i];
+        old[i] = n->chain;
+        uintptr_t g = (uintptr_t) n->nw;
+        g = g * 31 + (uintptr_t) n->ne;
+        g = g * 31 + (uintptr_t) n->sw;
+        g = g * 31 + (uintptr_t) n->se;
+        g ^= g >> 15;
+        unsigned int nb = g & (buckets.size() - 1);
+        n->chain = buckets[nb];
+        buckets[nb] = n;
+      }
+  }
+  return node;
+}
+
+/**
+ * Get the node of the given level that is all WALL.
+ * @param level the level of the node
+ * @return Node* the all WALL node.
+ */
+HashLife::Node* HashLife::wall(int level) {
+  while((int) walls.size() <= level) {
+    Node* w = walls.back();
+    walls.push_back(join(w, w, w, w));
+  }
+  return walls[level];
+}
+
+/**
+ * Build the node covering a square of the board.
+ * @param cells the board cells, row-major
+ * @param level the level of the node to build
+ * @param r the board row of the top left cell of the node
+ * @param c the board column of the top left cell of the node
+ * @return Node* the node.
+ */
+HashLife::Node* HashLife::build(const vector<State>& cells, int level, int r, int c) {
+  if(r >= rows || c >= cols)
+    return wall(level);
+  if(level == 0)
+    return leaves[cells[r * cols + c]];
+  int half = 1 << (level - 1);
+  return join(build(cells, level - 1, r, c),
+              build(cells, level - 1, r, c + half),
+              build(cells, level - 1, r + half, c),
+              build(cells, level - 1, r + half, c + half));
+}
+
+/**
+ * Surround a node with WALL so that it becomes the centre of a node one level up.
+ * @param node the node to pad
+ * @return Node* the padded node.
+ */
+HashLife::Node* HashLife::pad(Node* node) {
+  Node* w = wall(node->level - 1);
+  return join(join(w, w, w, node->nw),
+              join(w, w, node->ne, w),
+              join(w, node->sw, w, w),
+              join(node->se, w, w, w));
+}
+
+/**
+ * Advance the centre of a node.  Results are memoized on the node, so
+ * every distinct node is only ever computed once per step size.  When the
+ * node count is over the limit, unreachable nodes are freed before the
+ * node is computed.  The nodes in use by the recursion are kept in pinned,
+ * so collect() keeps them and the partial results built from them.
+ * @param node a node of level k >= 2
+ * @param step log2 of the number of generations, clamped to k - 2
+ * @return Node* the centre of node, level k - 1, 2^step generations later.
+ */
+HashLife::Node* HashLife::successor(Node* node, int step) {
+  int k = node->level;
+  if(step > k - 2)
+    step = k - 2;
+  if(node->population == 0 && node == wall(k))
+    return wall(k - 1);
+  if(node->result && node->resultStep == step)
+    return node->result;
+  
+  unsigned int base = pinned.size();
+  pinned.push_back(node);
+  if(nodeCount > collectAt)
+    collect();
+  
+  Node* result;
+  if(k == 2)
+    result = turnLeaves(node);
+  else {
+    int inner = (step < k - 3) ? step : k - 3;
+    Node* c[9];
+    c[0] = successor(node->nw, inner);
+    pinned.push_back(c[0]);
+    c[1] = successor(join(node->nw->ne, node->ne->nw, node->nw->se, node->ne->sw), inner);
+    pinned.push_back(c[1]);
+    c[2] = successor(node->ne, inner);
+    pinned.push_back(c[2]);
+    c[3] = successor(join(node->nw->sw, node->nw->se, node->sw->nw, node->sw->ne), inner);
+    pinned.push_back(c[3]);
+    c[4] = successor(join(node->nw->se, node->ne->sw, node->sw->ne, node->se->nw), inner);
+    pinned.push_back(c[4]);
+    c[5] = successor(join(node->ne->sw, node->ne->se, node->se->nw, node->se->ne), inner);
+    pinned.push_back(c[5]);
+    c[6] = successor(node->sw, inner);
+    pinned.push_back(c[6]);
+    c[7] = successor(join(node->sw->ne, node->se->nw, node->sw->se, node->se->sw), inner);
+    pinned.push_back(c[7]);
+    c[8] = successor(node->se, inner);
+    pinned.push_back(c[8]);
+    
+    if(step < k - 2)
+      result = join(join(c[0]->se, c[1]->sw, c[3]->ne, c[4]->nw),
+                    join(c[1]->se, c[2]->sw, c[4]->ne, c[5]->nw),
+                    join(c[3]->se, c[4]->sw, c[6]->ne, c[7]->nw),
+                    join(c[4]->se, c[5]->sw, c[7]->ne, c[8]->nw));
+    else {
+      Node* q[4];
+      q[0] = successor(join(c[0], c[1], c[3], c[4]), inner);
+      pinned.push_back(q[0]);
+      q[1] = successor(join(c[1], c[2], c[4], c[5]), inner);
+      pinned.push_back(q[1]);
+      q[2] = successor(join(c[3], c[4], c[6], c[7]), inner);
+      pinned.push_back(q[2]);
+      q[3] = successor(join(c[4], c[5], c[7], c[8]), inner);
+      result = join(q[0], q[1], q[2], q[3]);
+    }
+  }
+  pinned.resize(base);
+  node->result = result;
+  node->resultStep = step;
+  return result;
+}
+
+/**
+ * Advance the centre 2x2 of a 4x4 node by one generation.
+ * WALL cells stay WALL and count as dead neighbors.
+ * @param node a node of level 2
+ * @return Node* the centre of node, level 1, one generation later.
+ */
+HashLife::Node* HashLife::turnLeaves(Node* node) {
+  Node* centre[4];
+  for(int i = 0; i < 4; i++) {
+    int r = 1 + i / 2;
+    int c = 1 + i % 2;
+    State state = stateAt(node, r, c);
+    if(state == WALL) {
+      centre[i] = leaves[WALL];
+      continue;
+    }
+    int numNeighbors = 0;
+    for(unsigned int n = 0; n < conwayNeighbors.size(); n++)
+      numNeighbors += (stateAt(node, r + conwayNeighbors[n].r, c + conwayNeighbors[n].c) == ALIVE);
+    bool alive = (numNeighbors == 3) || (numNeighbors == 2 && state == ALIVE);
+    centre[i] = leaves[alive ? ALIVE : DEAD];
+  }
+  return join(centre[0], centre[1], centre[2], centre[3]);
+}
+
+/**
+ * Get the state of a cell within a node
+ * @param node the node to look in
+ * @param r the row of the cell relative to the top of node
+ * @param c the column of the cell relative to the left of node
+ * @return State the state of the cell.
+ */
+HashLife::State HashLife::stateAt(Node* node, int r, int c) const {
+  while(node->level > 0) {
+    int half = 1 << (node->level - 1);
+    if(r < half)
+      node = (c < half) ? node->nw : node->ne;
+    else
+      node = (c < half) ? node->sw : node->se;
+    r %= half;
+    c %= half;
+  }
+  return node->state;
+}
+
+/**
+ * Advance the board 2^step generations.  The root is grown with WALL until
+ * the step fits, then padded once more so its successor is the same square.
+ * @param step log2 of the number of generations to advance
+ */
+void HashLife::step(int step) {
+  while(root->level < step + 1) {
+    int half = 1 << (root->level - 1);
+    root = pad(root);
+    top -= half;
+    left -= half;
+  }
+  root = successor(pad(root), step);
+  if(nodeCount > collectAt)
+    collect();
+}
+
+/**
+ * Run the game the specified number of turns, one power of two at a time
+ * @param numTurns the number of turns to run for.
+ */
+void HashLife::simulate(int numTurns) {
+  if(numTurns <= 0)
+    return;
+  generation += numTurns;
+  for(int j = 0; numTurns; j++, numTurns >>= 1)
+    if(numTurns & 1)
+      step(j);
+  population = root->population;
+}
+
+/**
+ * Mark a node and everything below it as reachable.
+ * @param node the node to mark
+ */
+void HashLife::mark(Node* node) {
+  if(node->level == 0 || node->marked)
+    return;
+  node->marked = true;
+  mark(node->nw);
+  mark(node->ne);
+  mark(node->sw);
+  mark(node->se);
+}
+
+/**
+ * Free every node not reachable from the root, the WALL nodes or the nodes
+ * pinned by successor(), and forget the memoized results that point at
+ * freed nodes.  The next collection happens once the node count passes
+ * maxNodes, or twice the nodes kept, whichever is more, so that a board
+ * whose reachable nodes alone come near maxNodes is not collected on
+ * every successor.
+ */
+void HashLife::collect() {
+  mark(root);
+  for(unsigned int i = 0; i < walls.size(); i++)
+    mark(walls[i]);
+  for(unsigned int i = 0; i < pinned.size(); i++)
+    mark(pinned[i]);
+  for(unsigned int i = 0; i < buckets.size(); i++)
+    for(Node* node = buckets[i]; node; node = node->chain)
+      if(node->marked && node->result && !node->result->marked) {
+        node->result = 0;
+        node->resultStep = -1;
+      }
+  for(unsigned int i = 0; i < buckets.size(); i++) {
+    Node** link = &buckets[i];
+    while(*link) {
+      Node* node = *link;
+      if(node->marked) {
+        node->marked = false;
+        link = &node->chain;
+      }
+      else {
+        *link = node->chain;
+        delete node;
+        nodeCount--;
+      }
+    }
+  }
+  collectAt = max(maxNodes, 2 * nodeCount);
+}
+
+/**
+ * Print out the current state of the game in the same format as Life<ConwayCell>
+ * @param out the ostream& to print out to.
+ */
+void HashLife::print(ostream& out) {
+  out << "Generation = " << generation << ", Population = " << population << ".\n";
+  string line(cols + 1, '\n');
+  for(int r = 0; r < rows; r++) {
+    for(int c = 0; c < cols; c++)
+      line[c] = isAlive(r, c) ? '*' : '.';
+    out.write(line.data(), line.size());
+  }
+  out << '\n';
+}
+
+/**
+ * see if the specified cell is alive
+ * @param r the row of the cell
+ * @param c the column of the cell
+ * @return bool representing if the cell is alive or not.  Cells off the board are dead.
+ */
+bool HashLife::isAlive(int r, int c) const {
+  if(r < 0 || r >= rows || c < 0 || c >= cols)
+    return false;
+  return stateAt(root, r - top, c - left) == ALIVE;
+}
+
+/**
+ * Get the number of nodes currently allocated
+ * @return int the number of interior nodes in the hash table.
+ */
+int HashLife::nodes() const {
+  return nodeCount;
+}
+
+/**
+ * Get the largest number of nodes allocated at once so far
+ * @return int the peak of nodes().
+ */
+int HashLife::peakNodes() const {
+  return peakCount;
+}
+
+// ----------
+// SparseLife
+// ----------
+
+/**
+ * istream& SparseLife Constructor.  Reads the same format as Life<ConwayCell>
+ * and places the board with its top left cell at (0, 0) on an unbounded plane.
+ * Only 64x64 tiles with live cells are stored, bit c of bits[r] holding cell (r, c).
+ * @param in the istream& to read input from
+ */
+SparseLife::SparseLife(istream& in) {
+  generation = 0;
+  population = 0;
+  in >> rows;
+  in >> cols >> ws;
+  
+  for(int r = 0; r < rows; r++) {
+    for(int c = 0; c < cols; c++) {
+      char cell;
+      in >> cell;
+      if(cell == '*')
+        setAlive(r, c, true);
+    }
+    if(in)
+      in >> ws;
+  }
+}
+
+/**
+ * Get the tile coordinate of a cell coordinate, rounding toward negative infinity
+ * @param x the row or column of a cell
+ * @return int the row or column of the tile containing it.
+ */
+int SparseLife::tileOf(int x) {
+  if(x >= 0)
+    return x / 64;
+  return -((-x + 63) / 64);
+}
+
+/**
+ * Look up a tile
+ * @param tr the tile row
+ * @param tc the tile column
+ * @return const Tile* the tile, or 0 if it is not allocated.
+ */
+const SparseLife::Tile* SparseLife::find(int tr, int tc) const {
+  TileMap::const_iterator it = tiles.find(Key(tr, tc));
+  if(it == tiles.end())
+    return 0;
+  return &it->second;
+}
+
+/**
+ * Compute the next generation of one tile from it and its eight neighbors.
+ * Missing neighbor tiles are all dead.
+ * @param tr the tile row
+ * @param tc the tile column
+ * @param out the Tile to write the next generation into
+ */
+void SparseLife::turnTile(int tr, int tc, Tile& out) const {
+  const Tile* around[3][3];
+  for(int dr = 0; dr < 3; dr++)
+    for(int dc = 0; dc < 3; dc++)
+      around[dr][dc] = find(tr + dr - 1, tc + dc - 1);
+  
+  // rows -1 to 64 of the tile, with the neighboring bit from the west and east tiles
+  uint64_t mid[66];
+  uint64_t west[66];
+  uint64_t east[66];
+  for(int e = 0; e < 66; e++) {
+    int band = (e == 0) ? 0 : (e == 65) ? 2 : 1;
+    int row = (e + 63) % 64;
+    mid[e] = around[band][1] ? around[band][1]->bits[row] : 0;
+    west[e] = around[band][0] ? around[band][0]->bits[row] >> 63 : 0;
+    east[e] = around[band][2] ? around[band][2]->bits[row] << 63 : 0;
+  }
+  
+  for(int i = 0; i < 64; i++)
+    out.bits[i] = conwayWord((mid[i] << 1) | west[i], mid[i], (mid[i] >> 1) | east[i],
+                             (mid[i + 1] << 1) | west[i + 1], mid[i + 1], (mid[i + 1] >> 1) | east[i + 1],
+                             (mid[i + 2] << 1) | west[i + 2], mid[i + 2], (mid[i + 2] >> 1) | east[i + 2]);
+}
+
+/**
+ * Advance the board by one turn.  Every allocated tile is recomputed, as
+ * are the neighbors of tiles with live cells on their border.  Tiles that
+ * end up empty are freed.  The candidate list and nextTiles are kept from
+ * turn to turn: nextTiles still holds the tiles of the generation before,
+ * so each tile is computed straight into its existing node, and only tiles
+ * that appear or disappear are allocated or freed.
+ */
+void SparseLife::takeTurn() {
+  const uint64_t border = ((uint64_t) 1 << 63) | 1;
+  candidates.clear();
+  for(TileMap::const_iterator it = tiles.begin(); it != tiles.end(); ++it) {
+    const Tile& tile = it->second;
+    uint64_t any = 0;
+    for(int i = 0; i < 64; i++)
+      any |= tile.bits[i];
+    if(tile.bits[0] || tile.bits[63] || (any & border))
+      for(int dr = -1; dr <= 1; dr++)
+        for(int dc = -1; dc <= 1; dc++)
+          candidates.push_back(Key(it->first.first + dr, it->first.second + dc));
+    else
+      candidates.push_back(it->first);
+  }
+  sort(candidates.begin(), candidates.end());
+  candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+  
+  population = 0;
+  TileMap::iterator out = nextTiles.begin();
+  for(vector<Key>::const_iterator it = candidates.begin(); it != candidates.end(); ++it) {
+    while(out != nextTiles.end() && out->first < *it)
+      nextTiles.erase(out++);
+    if(out == nextTiles.end() || *it < out->first)
+      out = nextTiles.insert(out, make_pair(*it, Tile()));
+    turnTile(it->first, it->second, out->second);
+    int count = 0;
+    for(int i = 0; i < 64; i++)
+      count += popCount(out->second.bits[i]);
+    if(count) {
+      population += count;
+      ++out;
+    }
+    else
+      nextTiles.erase(out++);
+  }
+  nextTiles.erase(out, nextTiles.end());
+  tiles.swap(nextTiles);
+  generation++;
+}
+
+/**
+ * Run the game the specified number of turns
+ * @param numTurns the number of turns to run for.
+ */
+void SparseLife::simulate(int numTurns) {
+  while(numTurns-- > 0)
+    takeTurn();
+}
+
+/**
+ * Print out the current state of the game over the area of the original board
+ * @param out the ostream& to print out to.
+ */
+void SparseLife::print(ostream& out) {
+  print(out, 0, 0, rows, cols);
+}
+
+/**
+ * Print out the current state of the game over a window of the plane.
+ * Population counts the whole plane, not just the window.
+ * @param out the ostream& to print out to.
+ * @param top the row of the top left cell of the window
+ * @param left the column of the top left cell of the window
+ * @param numRows the height of the window
+ * @param numCols the width of the window
+ */
+void SparseLife::print(ostream& out, int top, int left, int numRows, int numCols) {
+  out << "Generation = " << generation << ", Population = " << population << ".\n";
+  string line(numCols + 1, '\n');
+  for(int r = top; r < top + numRows; r++) {
+    for(int c = left; c < left + numCols; c++)
+      line[c - left] = isAlive(r, c) ? '*' : '.';
+    out.write(line.data(), line.size());
+  }
+  out << '\n';
+}
+
+/**
+ * see if the specified cell is alive
+ * @param r the row of the cell
+ * @param c the column of the cell
+ * @return bool representing if the cell is alive or not.
+ */
+bool SparseLife::isAlive(int r, int c) const {
+  int tr = tileOf(r);
+  int tc = tileOf(c);
+  const Tile* tile = find(tr, tc);
+  if(!tile)
+    return false;
+  return (tile->bits[r - tr * 64] >> (c - tc * 64)) & 1;
+}
+
+/**
+ * Set the state of a cell, allocating its tile if needed
+ * @param r the row of the cell
+ * @param c the column of the cell
+ * @param alive the new state of the cell
+ */
+void SparseLife::setAlive(int r, int c, bool alive) {
+  int tr = tileOf(r);
+  int tc = tileOf(c);
+  if(!alive && !find(tr, tc))
+    return;
+  Tile& tile = tiles[Key(tr, tc)];
+  uint64_t bit = (uint64_t) 1 << (c - tc * 64);
+  uint64_t& word = tile.bits[r - tr * 64];
+  if(alive && !(word & bit)) {
+    word |= bit;
+    population++;
+  }
+  else if(!alive && (word & bit)) {
+    word &= ~bit;
+    population--;
+  }
+}
+
+/**
+ * Get the number of allocated tiles
+ * @return int the number of 64x64 tiles currently stored.
+ */
+int SparseLife::tileCount() const {
+  return (int) tiles.size();
+}
+
+// -----------
+// FredkinLife
+// -----------
+
+/**
+ * Apply the Fredkin rule to cells [first, last) of a row, one cell at a time.
+ * A cell is alive next turn if an odd number of its 4 neighbors are alive,
+ * and its age goes up by one, saturating at 255, if it stays alive.
+ * @param cur the row of the current alive plane
+ * @param next the row of the next alive plane
+ * @param age the row of the age plane
+ * @param stride the distance between rows of the planes
+ * @param first the first column to compute
+ * @param last one past the last column to compute
+ * @return int the number of cells alive next turn.
+ */
+inline int fredkinCells(const uint8_t* cur, uint8_t* next, uint8_t* age, int stride, int first, int last) {
+  int population = 0;
+  for(int c = first; c < last; c++) {
+    uint8_t odd = cur[c - stride] ^ cur[c + stride] ^ cur[c - 1] ^ cur[c + 1];
+    next[c] = odd;
+    if(cur[c] & odd & (age[c] != 255))
+      age[c]++;
+    population += odd;
+  }
+  return population;
+}
+
+/**
+ * Scalar row kernel for FredkinLife
+ * @param cur the row of the current alive plane
+ * @param next the row of the next alive plane
+ * @param age the row of the age plane
+ * @param stride the distance between rows of the planes
+ * @param cols the number of cells in the row
+ * @return int the number of cells alive next turn.
+ */
+inline int fredkinRowScalar(const uint8_t* cur, uint8_t* next, uint8_t* age, int stride, int cols) {
+  return fredkinCells(cur, next, age, stride, 0, cols);
+}
+
+#ifdef LIFE_X86
+/**
+ * SSE2 row kernel for FredkinLife, 16 cells at a time
+ * @param cur the row of the current alive plane
+ * @param next the row of the next alive plane
+ * @param age the row of the age plane
+ * @param stride the distance between rows of the planes
+ * @param cols the number of cells in the row
+ * @return int the number of cells alive next turn.
+ */
+__attribute__((target("sse2")))
+inline int fredkinRowSSE2(const uint8_t* cur, uint8_t* next, uint8_t* age, int stride, int cols) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i sums = zero;
+  int c = 0;
+  for(; c + 16 <= cols; c += 16) {
+    __m128i self = _mm_loadu_si128((const __m128i*) (cur + c));
+    __m128i odd = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128((const __m128i*) (cur + c - stride)),
+                                              _mm_loadu_si128((const __m128i*) (cur + c + stride))),
+                                _mm_xor_si128(_mm_loadu_si128((const __m128i*) (cur + c - 1)),
+                                              _mm_loadu_si128((const __m128i*) (cur + c + 1))));
+    _mm_storeu_si128((__m128i*) (next + c), odd);
+    __m128i a = _mm_loadu_si128((const __m128i*) (age + c));
+    _mm_storeu_si128((__m128i*) (age + c), _mm_adds_epu8(a, _mm_and_si128(self, odd)));
+    sums = _mm_add_epi64(sums, _mm_sad_epu8(odd, zero));
+  }
+  int population = _mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+  return population + fredkinCells(cur, next, age, stride, c, cols);
+}
+
+/**
+ * AVX2 row kernel for FredkinLife, 32 cells at a time
+ * @param cur the row of the current alive plane
+ * @param next the row of the next alive plane
+ * @param age the row of the age plane
+ * @param stride the distance between rows of the planes
+ * @param cols the number of cells in the row
+ * @return int the number of cells alive next turn.
+ */
+__attribute__((target("avx2")))
+inline int fredkinRowAVX2(const uint8_t* cur, uint8_t* next, uint8_t* age, int stride, int cols) {
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i sums = zero;
+  int c = 0;
+  for(; c + 32 <= cols; c += 32) {
+    __m256i self = _mm256_loadu_si256((const __m256i*) (cur + c));
+    __m256i odd = _mm256_xor_si256(_mm256_xor_si256(_mm256_loadu_si256((const __m256i*) (cur + c - stride)),
+                                                    _mm256_loadu_si256((const __m256i*) (cur + c + stride))),
+                                   _mm256_xor_si256(_mm256_loadu_si256((const __m256i*) (cur + c - 1)),
+                                                    _mm256_loadu_si256((const __m256i*) (cur + c + 1))));
+    _mm256_storeu_si256((__m256i*) (next + c), odd);
+    __m256i a = _mm256_loadu_si256((const __m256i*) (age + c));
+    _mm256_storeu_si256((__m256i*) (age + c), _mm256_adds_epu8(a, _mm256_and_si256(self, odd)));
+    sums = _mm256_add_epi64(sums, _mm256_sad_epu8(odd, zero));
+  }
+  __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+  int population = _mm_cvtsi128_si32(half) + _mm_cvtsi128_si32(_mm_srli_si128(half, 8));
+  return population + fredkinCells(cur, next, age, stride, c, cols);
+}
+#endif
+
+/**
+ * istream& FredkinLife Constructor.  Reads the same format as Life<FredkinCell>.
+ * Alive flags and ages are kept in separate byte planes with a dead border
+ * one cell wide, and ages saturate at 255.  The fastest kernel the CPU
+ * supports is picked.
+ * @param in the istream& to read input from
+ */
+FredkinLife::FredkinLife(istream& in) {
+  generation = 0;
+  population = 0;
+  in >> rows;
+  in >> cols >> ws;
+  stride = (cols + 2 + 31) / 32 * 32;
+  alive.assign((rows + 2) * stride, 0);
+  nextAlive.assign((rows + 2) * stride, 0);
+  age.assign((rows + 2) * stride, 0);
+  
+  for(int r = 0; r < rows; r++) {
+    for(int c = 0; c < cols; c++) {
+      char cell;
+      in >> cell;
+      if(cell != '-') {
+        alive[(r + 1) * stride + c + 1] = 1;
+        age[(r + 1) * stride + c + 1] = cell & 0xF;
+        population++;
+      }
+    }
+    if(in)
+      in >> ws;
+  }
+  
+  if(supported(AVX2))
+    setKernel(AVX2);
+  else if(supported(SSE2))
+    setKernel(SSE2);
+  else
+    setKernel(SCALAR);
+}
+
+/**
+ * See if this CPU can run a kernel
+ * @param k the kernel to check
+ * @return bool true if setKernel(k) will succeed.
+ */
+bool FredkinLife::supported(Kernel k) {
+  if(k == SCALAR)
+    return true;
+#ifdef LIFE_X86
+  __builtin_cpu_init();
+  if(k == SSE2)
+    return __builtin_cpu_supports("sse2");
+  if(k == AVX2)
+    return __builtin_cpu_supports("avx2");
+#endif
+  return false;
+}
+
+/**
+ * Choose the row kernel used by simulate()
+ * @param k the kernel to use
+ */
+void FredkinLife::setKernel(Kernel k) {
+  if(!supported(k))
+    throw invalid_argument("kernel not supported on this CPU");
+  kernel = k;
+  turnRow = fredkinRowScalar;
+#ifdef LIFE_X86
+  if(k == SSE2)
+    turnRow = fredkinRowSSE2;
+  if(k == AVX2)
+    turnRow = fredkinRowAVX2;
+#endif
+}
+
+/**
+ * Get the row kernel used by simulate()
+ * @return Kernel the current kernel.
+ */
+FredkinLife::Kernel FredkinLife::getKernel() const {
+  return kernel;
+}
+
+/**
+ * Advance the board by one turn
+ */
+void FredkinLife::takeTurn() {
+  population = 0;
+  for(int r = 0; r < rows; r++) {
+    int i = (r + 1) * stride + 1;
+    population += turnRow(&alive[i], &nextAlive[i], &age[i], stride, cols);
+  }
+  alive.swap(nextAlive);
+  generation++;
+}
+
+/**
+ * Run the game the specified number of turns
+ * @param numTurns the number of turns to run for.
+ */
+void FredkinLife::simulate(int numTurns) {
+  while(numTurns-- > 0)
+    takeTurn();
+}
+
+/**
+ * Print out the current state of the game in the same format as Life<FredkinCell>
+ * @param out the ostream& to print out to.
+ */
+void FredkinLife::print(ostream& out) {
+  out << "Generation = " << generation << ", Population = " << population << ".\n";
+  string line(cols + 1, '\n');
+  for(int r = 0; r < rows; r++) {
+    for(int c = 0; c < cols; c++) {
+      if(!isAlive(r, c))
+        line[c] = '-';
+      else if(getAge(r, c) > 9)
+        line[c] = '+';
+      else
+        line[c] = (char) (getAge(r, c) + 0x30);
+    }
+    out.write(line.data(), line.size());
+  }
+  out << '\n';
+}
+
+/**
+ * see if the specified cell is alive
+ * @param r the row of the cell
+ * @param c the column of the cell
+ * @return bool representing if the cell is alive or not.  Cells off the board are dead.
+ */
+bool FredkinLife::isAlive(int r, int c) const {
+  if(r < 0 || r >= rows || c < 0 || c >= cols)
+    return false;
+  return alive[(r + 1) * stride + c + 1];
+}
+
+/**
+ * Get the age of the specified cell
+ * @param r the row of the cell
+ * @param c the column of the cell
+ * @return int the age of the cell, at most 255.
+ */
+int FredkinLife::getAge(int r, int c) const {
+  return age[(r + 1) * stride + c + 1];
+}
+
+// ----
+// Rule
+// ----
+
+/**
+ * Apply the rule to one cell.  B and S are bit sets of the neighbor counts
+ * that give birth and survival, so the lookup table is the template
+ * argument itself and the compiler folds it into the caller.
+ * @param alive whether the cell is alive
+ * @param numNeighbors the number of alive neighbors of the cell
+ * @return bool whether the cell is alive in the next generation.
+ */
+template <unsigned int B, unsigned int S>
+bool Rule<B, S>::next(bool alive, int numNeighbors) {
+  return ((alive ? S : B) >> numNeighbors) & 1;
 }
 
+// ------
+// Offset
+// ------
+
 /**
- * Get the character representing the current state of the Cell
- * @return char representing the state of the cell
+ * End of a neighborhood
+ * @return int 0.
  */
-char Cell::name() const {
-  return ptr->name();
+int NoOffset::count(const uint8_t*, int) {
+  return 0;
 }
 
 /**
- * set the neighbor count of the Cell
- * @param n the value to set the neighbor count to.
+ * Count the alive cells at this offset and the ones after it.  The recursion
+ * is resolved at compile time, so a neighborhood becomes one sum of loads.
+ * @param cell the cell whose neighbors to count
+ * @param stride the distance between rows
+ * @return int the number of alive neighbors.
  */
-void Cell::setNeighbors(int n) {
-  ptr->setNeighbors(n);
+template <int R, int C, typename Next>
+int Offset<R, C, Next>::count(const uint8_t* cell, int stride) {
+  return cell[R * stride + C] + Next::count(cell, stride);
 }
 
+// --------
+// RuleLife
+// --------
+
 /**
- * Conversion to bool
- * return the conversion to bool of the contained AbstractCell
+ * istream& RuleLife Constructor.  Reads the same format as Life<T>; '.'
+ * and '-' are dead cells and every other char is an alive cell.  The cells
+ * are kept one byte each with a dead border as wide as the neighborhood.
+ * @param in the istream& to read input from
  */
-Cell::operator bool(){
-  return *ptr;
+template <typename R, typename N>
+RuleLife<R, N>::RuleLife(istream& in) {
+  generation = 0;
+  population = 0;
+  in >> rows;
+  in >> cols >> ws;
+  stride = cols + 2 * N::radius;
+  grid.assign((rows + 2 * N::radius) * stride, 0);
+  
+  for(int r = 0; r < rows; r++) {
+    for(int c = 0; c < cols; c++) {
+      char cell;
+      in >> cell;
+      if(cell != '.' && cell != '-') {
+        grid[index(r, c)] = 1;
+        population++;
+      }
+    }
+    if(in)
+      in >> ws;
+  }
+  next = grid;
 }
 
 /**
- * Conversion to int
- * return the conversion to int of the contained AbstractCell
+ * File RuleLife Constructor.  Reads any format Pattern reads.
+ * @param fileName the name of the file to read
  */
-Cell::operator int() {
-  return *ptr;
+template <typename R, typename N>
+RuleLife<R, N>::RuleLife(const char* fileName) {
+  Pattern pattern(fileName);
+  generation = 0;
+  population = 0;
+  rows = pattern.rows;
+  cols = pattern.cols;
+  stride = cols + 2 * N::radius;
+  grid.assign((rows + 2 * N::radius) * stride, 0);
+  
+  for(int r = 0; r < rows; r++)
+    for(int c = 0; c < cols; c++) {
+      char cell = pattern.cells[r * cols + c];
+      if(cell != '.' && cell != '-') {
+        grid[index(r, c)] = 1;
+        population++;
+      }
+    }
+  next = grid;
 }
 
-// -----------
-// Conway Cell
-// -----------
+/**
+ * Get the index of a cell in the padded grid
+ * @param r the row of the cell
+ * @param c the column of the cell
+ * @return int the index of the cell in grid and next.
+ */
+template <typename R, typename N>
+int RuleLife<R, N>::index(int r, int c) const {
+  return (r + N::radius) * stride + c + N::radius;
+}
 
 /**
- * char constructor for ConwayCell
- * @param char representing the initial state of the cell.
+ * Advance the board by one turn.  The border is never written, so it stays dead.
  */
-ConwayCell::ConwayCell(char c) {
-  if (c == '.')
-    alive = false;
-  else if (c == '*')
-    alive = true;
+template <typename R, typename N>
+void RuleLife<R, N>::takeTurn() {
+  population = 0;
+  for(int r = 0; r < rows; r++) {
+    const uint8_t* cell = &grid[index(r, 0)];
+    uint8_t* result = &next[index(r, 0)];
+    for(int c = 0; c < cols; c++) {
+      result[c] = R::next(cell[c], N::count(cell + c, stride));
+      population += result[c];
+    }
+  }
+  grid.swap(next);
+  generation++;
 }
 
 /**
- * Advance the cell state by one turn.
+ * Run the game the specified number of turns
+ * @param numTurns the number of turns to run for.
  */
-void ConwayCell::turn() {
-  if (numNeighbors == 3)
-    alive = true;
-  else if (numNeighbors < 2 || numNeighbors > 3)
-    alive = false;
-  else
-    alive = alive; //do nothing
+template <typename R, typename N>
+void RuleLife<R, N>::simulate(int numTurns) {
+  while(numTurns-- > 0)
+    takeTurn();
 }
 
 /**
- * Get a Position vector representing the Positions to consider as neighbors.
- * @return const vector<Position>& representing the relative Positions to consider as neighbors.
+ * Print out the current state of the game
+ * @param out the ostream& to print out to.
  */
-const vector<Position>& ConwayCell::neighbors() const {
-  return conwayNeighbors;
+template <typename R, typename N>
+void RuleLife<R, N>::print(ostream& out) {
+  out << "Generation = " << generation << ", Population = " << population << ".\n";
+  string line(cols + 1, '\n');
+  for(int r = 0; r < rows; r++) {
+    for(int c = 0; c < cols; c++)
+      line[c] = grid[index(r, c)] ? '*' : '.';
+    out.write(line.data(), line.size());
+  }
+  out << '\n';
 }
 
 /**
- * Get the character representing the current state of the Cell
- * @return char representing the state of the cell
+ * see if the specified cell is alive
+ * @param r the row of the cell
+ * @param c the column of the cell
+ * @return bool representing if the cell is alive or not.  Cells off the board are dead.
  */
-char ConwayCell::name() const {
-  if(alive)
-    return '*';
-  return '.';
+template <typename R, typename N>
+bool RuleLife<R, N>::isAlive(int r, int c) const {
+  if(r < 0 || r >= rows || c < 0 || c >= cols)
+    return false;
+  return grid[index(r, c)];
 }
 
+// ---------
+// BatchLife
+// ---------
+
 /**
- * Create a clone of the cell
- * @return pointer to the new cell.
+ * Default BatchLife Constructor.  Starts with no boards.
  */
-AbstractCell* ConwayCell::clone() const {
-  return new ConwayCell(*this);
+BatchLife::BatchLife() {
+  numThreads = 1;
+  pendingTurns = 0;
+  nextSlice = 0;
 }
 
+/**
+ * Read a board in the format read by Life<ConwayCell> and add it to the batch.
+ * Boards of the same size share a slice of 64 boards, one per bit of each
+ * word, so one word operation advances the same cell of all 64 boards.
+ * A board joins the open slice of its size if that slice has room and has
+ * not been simulated yet; otherwise it starts a new slice.  The whole
+ * board is read before it joins a slice, so a bad board leaves the batch as it was.
+ * @param in the istream& to read input from
+ * @return int the index of the new board.
+ * @throws invalid_argument if rows or cols is not positive, or a cell is
+ * missing or is not '.' or '*'.
+ */
+int BatchLife::add(istream& in) {
+  int rows = 0;
+  int cols = 0;
+  in >> rows;
+  in >> cols >> ws;
+  if(!in || rows <= 0 || cols <= 0)
+    throw invalid_argument("rows and cols must be positive");
+  vector<bool> alive;
+  alive.reserve(rows * cols);
+  for(int r = 0; r < rows; r++) {
+    for(int c = 0; c < cols; c++) {
+      char cell = 0;
+      in >> cell;
+      if(cell != '.' && cell != '*')
+        throw invalid_argument("BatchLife cells must be '.' or '*'");
+      alive.push_back(cell == '*');
+    }
+    if(in)
+      in >> ws;
+  }
+  
+  pair<int, int> key(rows, cols);
+  map<pair<int, int>, int>::iterator open = openSlice.find(key);
+  if(open == openSlice.end() || slices[open->second].boards == 64 || slices[open->second].generation != 0) {
+    Slice slice;
+    slice.rows = rows;
+    slice.cols = cols;
+    slice.boards = 0;
+    slice.generation = 0;
+    slice.grid.assign((rows + 2) * (cols + 2), 0);
+    slice.next = slice.grid;
+    slices.push_back(slice);
+    openSlice[key] = slices.size() - 1;
+  }
+  Board board;
+  board.slice = openSlice[key];
+  Slice& slice = slices[board.slice];
+  board.lane = slice.boards++;
+  
+  const uint64_t bit = (uint64_t) 1 << board.lane;
+  for(int r = 0; r < rows; r++)
+    for(int c = 0; c < cols; c++)
+      if(alive[r * cols + c])
+        slice.grid[(r + 1) * (cols + 2) + c + 1] |= bit;
+  boards.push_back(board);
+  return boards.size() - 1;
+}
 
-// ------------
-// Fredkin Cell
-// ------------
+/**
+ * Advance all 64 boards of a slice by one turn.  The border of the slice is
+ * never written, so every board has dead edges, the same as Life<ConwayCell>.
+ * @param slice the slice to advance
+ */
+void BatchLife::turnSlice(Slice& slice) {
+  const int stride = slice.cols + 2;
+  const uint64_t* g = &slice.grid[0];
+  for(int r = 1; r <= slice.rows; r++)
+    for(int i = r * stride + 1; i <= r * stride + slice.cols; i++)
+      slice.next[i] = conwayWord(g[i - stride - 1], g[i - stride], g[i - stride + 1],
+                                 g[i - 1],          g[i],          g[i + 1],
+                                 g[i + stride - 1], g[i + stride], g[i + stride + 1]);
+  slice.grid.swap(slice.next);
+  slice.generation++;
+}
 
 /**
- * char constructor for FredkinCell
- * @param char representing the initial state of the cell.
+ * Take slices until there are none left and run each one pendingTurns
+ * generations.  Slices are independent, so each thread takes the next
+ * unclaimed slice as soon as it is done with the last one, and threads
+ * that finish early take over the rest of the work from slower ones.
  */
-FredkinCell::FredkinCell(char c) {
-  age = 0;
-  if (c == '-')
-    alive = false;
-  else {
-    alive = true;
-    age = c & 0xF;
-  } 
+void BatchLife::runSlices() {
+  int turns = pendingTurns;
+  while(true) {
+    int s = __sync_fetch_and_add(&nextSlice, 1);
+    if(s >= (int) slices.size())
+      return;
+    for(int t = 0; t < turns; t++)
+      turnSlice(slices[s]);
+  }
 }
 
 /**
- * Advance the cell state by one turn.
+ * Worker thread body
+ * @param arg the BatchLife to work on
+ * @return 0
  */
-void FredkinCell::turn() {
-  if (numNeighbors % 2 == 1) {
-    if(alive)
-      age++;
-    alive = true;
+void* BatchLife::work(void* arg) {
+  static_cast<BatchLife*>(arg)->runSlices();
+  return 0;
+}
+
+/**
+ * Run every board the specified number of turns.  With more than one thread
+ * the slices are spread across the threads as they free up.  Since the
+ * calling thread takes slices too, a thread that cannot be created only
+ * leaves its share of the slices to the others.
+ * @param numTurns the number of turns to run for.
+ */
+void BatchLife::simulate(int numTurns) {
+  if(numTurns <= 0)
+    return;
+  pendingTurns = numTurns;
+  nextSlice = 0;
+  vector<pthread_t> threads;
+  for(int t = 1; t < numThreads && t < (int) slices.size(); t++) {
+    pthread_t thread;
+    if(pthread_create(&thread, 0, work, this) != 0)
+      break;
+    threads.push_back(thread);
   }
-  else
-    alive = false;
+  runSlices();
+  for(unsigned int t = 0; t < threads.size(); t++)
+    pthread_join(threads[t], 0);
 }
 
 /**
- * Get a Position vector representing the Positions to consider as neighbors.
- * @return const vector<Position>& representing the relative Positions to consider as neighbors.
+ * Print out the current state of one board in the same format as Life<ConwayCell>
+ * @param i the index add() returned for the board
+ * @param out the ostream& to print out to.
  */
-const vector<Position>& FredkinCell::neighbors() const {
-  return fredkinNeighbors;
+void BatchLife::print(int i, ostream& out) {
+  const Slice& slice = slices.at(boards.at(i).slice);
+  out << "Generation = " << slice.generation << ", Population = " << getPopulation(i) << ".\n";
+  string line(slice.cols + 1, '\n');
+  for(int r = 0; r < slice.rows; r++) {
+    for(int c = 0; c < slice.cols; c++)
+      line[c] = isAlive(i, r, c) ? '*' : '.';
+    out.write(line.data(), line.size());
+  }
+  out << '\n';
 }
 
 /**
- * Get the character representing the current state of the Cell
- * @return char representing the state of the cell
+ * Set the number of threads simulate() uses
+ * @param n the number of threads, including the calling thread.
  */
-char FredkinCell::name() const {
-  if(!alive)
-    return '-';
-  if(age > 9)
-    return '+';
-  return (char) (age + 0x30);
+void BatchLife::setThreads(int n) {
+  if(n < 1)
+    throw invalid_argument("n must be at least 1");
+  numThreads = n;
 }
 
 /**
- * Conversion to int.
- * @return the age of the cell.
+ * Get the number of boards in the batch
+ * @return int the number of boards added.
  */
-FredkinCell::operator int() {
-  return age;
+int BatchLife::size() const {
+  return boards.size();
 }
 
 /**
- * Create a clone of the cell
- * @return pointer to the new cell.
+ * Count the alive cells of one board
+ * @param i the index add() returned for the board
+ * @return int the population of the board.
  */
-AbstractCell* FredkinCell::clone() const {
-  return new FredkinCell(*this);
+int BatchLife::getPopulation(int i) const {
+  const Board& board = boards.at(i);
+  const Slice& slice = slices[board.slice];
+  int population = 0;
+  for(unsigned int k = 0; k < slice.grid.size(); k++)
+    population += (slice.grid[k] >> board.lane) & 1;
+  return population;
+}
+
+/**
+ * see if the specified cell of one board is alive
+ * @param i the index add() returned for the board
+ * @param r the row of the cell
+ * @param c the column of the cell
+ * @return bool representing if the cell is alive or not.  Cells off the board are dead.
+ */
+bool BatchLife::isAlive(int i, int r, int c) const {
+  const Board& board = boards.at(i);
+  const Slice& slice = slices[board.slice];
+  if(r < 0 || r >= slice.rows || c < 0 || c >= slice.cols)
+    return false;
+  return (slice.grid[(r + 1) * (slice.cols + 2) + c + 1] >> board.lane) & 1;
+}
+
+// ---------
+// ShardLife
+// ---------
+
+/**
+ * istream& ShardLife Constructor.  Reads the same format as Life<T> and
+ * splits the rows into one band per worker process.  Each worker keeps its
+ * band, plus a copy of the row above and the row below it, in a Life<T>
+ * of its own.  The rows are read one band at a time and each band is
+ * handed to its worker as it is forked, so no process ever holds the whole
+ * board.  The workers share one POSIX shared memory segment with the
+ * coordinator, the calling process, which holds a process-shared barrier
+ * for the turns, a semaphore per worker to start a command and one to
+ * report it finished, the population of each band, the top and bottom rows
+ * of each band for the neighboring bands to read, and room for the largest
+ * band when print() gathers the board.  The segment is unlinked as soon as
+ * it is mapped, so nothing is left behind if a process dies.
+ * @param in the istream& to read input from
+ * @param numWorkers the number of worker processes, at most the number of rows
+ */
+template <typename T>
+ShardLife<T>::ShardLife(istream& in, int numWorkers) : numWorkers(numWorkers) {
+  in >> rows;
+  in >> cols >> ws;
+  generation = 0;
+  population = 0;
+  if(numWorkers < 1 || numWorkers > rows)
+    throw invalid_argument("numWorkers must be between 1 and the number of rows");
+  
+  int bandRows = (rows + numWorkers - 1) / numWorkers;
+  size_t commandsOffset = (sizeof(Control) + 63) / 64 * 64;
+  size_t populationsOffset = commandsOffset + (numWorkers + 1) * sizeof(sem_t);
+  size_t edgesOffset = populationsOffset + numWorkers * sizeof(int);
+  size_t stagingOffset = edgesOffset + 2 * numWorkers * cols * sizeof(CellState);
+  sharedSize = stagingOffset + (size_t) bandRows * cols * sizeof(CellState);
+  
+  ostringstream name;
+  name << "/life-" << getpid() << "-" << this;
+  int fd = shm_open(name.str().c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if(fd < 0)
+    throw runtime_error("cannot create shared memory");
+  shm_unlink(name.str().c_str());
+  if(ftruncate(fd, sharedSize) != 0) {
+    close(fd);
+    throw runtime_error("cannot size shared memory");
+  }
+  shared = mmap(0, sharedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if(shared == MAP_FAILED)
+    throw runtime_error("cannot map shared memory");
+  control = (Control*) shared;
+  commands = (sem_t*) ((char*) shared + commandsOffset);
+  finished = commands + numWorkers;
+  populations = (int*) ((char*) shared + populationsOffset);
+  edges = (CellState*) ((char*) shared + edgesOffset);
+  staging = (CellState*) ((char*) shared + stagingOffset);
+  
+  pthread_barrierattr_t attr;
+  pthread_barrierattr_init(&attr);
+  pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+  int ready = pthread_barrier_init(&control->turn, &attr, numWorkers);
+  pthread_barrierattr_destroy(&attr);
+  if(ready != 0) {
+    munmap(shared, sharedSize);
+    throw runtime_error("cannot create barrier");
+  }
+  for(ready = 0; ready <= numWorkers; ready++)
+    if(sem_init(&commands[ready], 1, 0) != 0)
+      break;
+  if(ready <= numWorkers) {
+    while(ready > 0)
+      sem_destroy(&commands[--ready]);
+    pthread_barrier_destroy(&control->turn);
+    munmap(shared, sharedSize);
+    throw runtime_error("cannot create semaphore");
+  }
+  
+  try {
+    for(int w = 0; w < numWorkers; w++) {
+      Life<T> band(firstRow(w + 1) - firstRow(w) + 2, cols);
+      for(int r = 1; r <= firstRow(w + 1) - firstRow(w); r++) {
+        for(int c = 0; c < cols; c++) {
+          char cell;
+          in >> cell;
+          band.at(r, c) = T(cell);
+          if(band.at(r, c))
+            population++;
+        }
+        if(in)
+          in >> ws;
+      }
+      pid_t pid = fork();
+      if(pid < 0)
+        throw runtime_error("cannot fork worker process");
+      if(pid == 0) {
+        try {
+          work(w, band);
+        }
+        catch(...) {
+          _exit(1);
+        }
+        _exit(0);
+      }
+      workers.push_back(pid);
+    }
+  }
+  catch(...) {
+    stopWorkers();
+    unmap();
+    throw;
+  }
+}
+
+/**
+ * Destructor.  Stops the worker processes and unmaps the shared memory.
+ */
+template <typename T>
+ShardLife<T>::~ShardLife() {
+  if(!workers.empty()) {
+    runCommand(STOP, 0);
+    for(unsigned int w = 0; w < workers.size(); w++)
+      waitpid(workers[w], 0, 0);
+    pthread_barrier_destroy(&control->turn);
+  }
+  unmap();
+}
+
+/**
+ * Get the first row of a worker's band
+ * @param worker the index of the worker, or numWorkers for one past the last row
+ * @return int the first row of the band.
+ */
+template <typename T>
+int ShardLife<T>::firstRow(int worker) const {
+  return rows * worker / numWorkers;
+}
+
+/**
+ * Destroy the semaphores and unmap the shared memory.  The barrier is left
+ * to the caller: pthread_barrier_destroy() waits for every process in the
+ * barrier to leave it, which killed workers never do.
+ */
+template <typename T>
+void ShardLife<T>::unmap() {
+  for(int w = 0; w <= numWorkers; w++)
+    sem_destroy(&commands[w]);
+  munmap(shared, sharedSize);
+}
+
+/**
+ * Kill and reap the worker processes that are still running.
+ */
+template <typename T>
+void ShardLife<T>::stopWorkers() {
+  for(unsigned int w = 0; w < workers.size(); w++) {
+    kill(workers[w], SIGKILL);
+    waitpid(workers[w], 0, 0);
+  }
+  workers.clear();
+}
+
+/**
+ * Have every worker carry out a command, and wait for them to finish.
+ * @param c the command
+ * @param arg the number of turns for STEP, or the band to copy for GATHER
+ * @throws runtime_error if a worker process has died.
+ */
+template <typename T>
+void ShardLife<T>::runCommand(Command c, int arg) {
+  if(workers.empty())
+    throw runtime_error("worker processes have stopped");
+  control->next = c;
+  control->argument = arg;
+  for(int w = 0; w < numWorkers; w++)
+    sem_post(&commands[w]);
+  if(c != STOP)
+    awaitWorkers();
+}
+
+/**
+ * Wait for every worker to report the command finished.  A worker that
+ * died would leave the others waiting at the turn barrier and the
+ * coordinator waiting here, so the wait wakes up every 100 ms to look for
+ * dead workers, and if it finds one, stops the rest.
+ * @throws runtime_error if a worker process has died.
+ */
+template <typename T>
+void ShardLife<T>::awaitWorkers() {
+  int done = 0;
+  while(done < numWorkers) {
+    timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += 100000000;
+    if(deadline.tv_nsec >= 1000000000) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000;
+    }
+    if(sem_timedwait(finished, &deadline) == 0) {
+      done++;
+      continue;
+    }
+    for(unsigned int w = 0; w < workers.size(); w++)
+      if(waitpid(workers[w], 0, WNOHANG) != 0) {
+        workers.erase(workers.begin() + w);
+        stopWorkers();
+        throw runtime_error("worker process died");
+      }
+  }
+}
+
+/**
+ * Worker process body.  Publishes the band's edge rows, then carries out
+ * commands until told to stop.
+ * @param worker the index of the worker
+ * @param band the worker's rows, with a row of the neighboring bands above and below
+ */
+template <typename T>
+void ShardLife<T>::work(int worker, Life<T>& band) {
+  const int bandRows = band.rows - 2;
+  for(int c = 0; c < cols; c++) {
+    edges[(2 * worker) * cols + c] = band.at(1, c).state();
+    edges[(2 * worker + 1) * cols + c] = band.at(bandRows, c).state();
+  }
+  pthread_barrier_wait(&control->turn);
+  while(true) {
+    while(sem_wait(&commands[worker]) != 0)
+      ;
+    if(control->next == STOP)
+      return;
+    if(control->next == STEP) {
+      for(int t = 0; t < control->argument; t++)
+        exchange(worker, band);
+      int interior = 0;
+      for(int r = 1; r <= bandRows; r++)
+        for(int c = 0; c < cols; c++)
+          interior += (bool) band.at(r, c);
+      populations[worker] = interior;
+    }
+    else if(control->argument == worker) {
+      for(int r = 1; r <= bandRows; r++)
+        for(int c = 0; c < cols; c++)
+          staging[(r - 1) * cols + c] = band.at(r, c).state();
+    }
+    sem_post(finished);
+  }
+}
+
+/**
+ * Advance a worker's band by one turn.  The rows above and below the band
+ * are copied from the neighboring bands' edges, or are dead at the top and
+ * bottom of the board.  After every band has read the edges, each band
+ * takes its turn and publishes its new edges; the second barrier keeps the
+ * next turn from reading them early.
+ * @param worker the index of the worker
+ * @param band the worker's rows, with a row of the neighboring bands above and below
+ */
+template <typename T>
+void ShardLife<T>::exchange(int worker, Life<T>& band) {
+  const int bandRows = band.rows - 2;
+  for(int c = 0; c < cols; c++) {
+    band.at(0, c) = worker > 0 ? T(edges[(2 * worker - 1) * cols + c]) : T();
+    band.at(bandRows + 1, c) = worker < numWorkers - 1 ? T(edges[(2 * worker + 2) * cols + c]) : T();
+  }
+  pthread_barrier_wait(&control->turn);
+  band.simulate(1);
+  for(int c = 0; c < cols; c++) {
+    edges[(2 * worker) * cols + c] = band.at(1, c).state();
+    edges[(2 * worker + 1) * cols + c] = band.at(bandRows, c).state();
+  }
+  pthread_barrier_wait(&control->turn);
+}
+
+/**
+ * Run the game the specified number of turns.  The workers run all the
+ * turns before reporting back, exchanging edges between every turn.
+ * @param numTurns the number of turns to run for.
+ */
+template <typename T>
+void ShardLife<T>::simulate(int numTurns) {
+  if(numTurns <= 0)
+    return;
+  runCommand(STEP, numTurns);
+  generation += numTurns;
+  population = 0;
+  for(int w = 0; w < numWorkers; w++)
+    population += populations[w];
+}
+
+/**
+ * Print out the current state of the game in the same format as Life<T>.
+ * The bands are gathered from the workers and written one at a time.
+ * @param out the ostream& to print out to.
+ */
+template <typename T>
+void ShardLife<T>::print(ostream& out) {
+  out << "Generation = " << generation << ", Population = " << population << ".\n";
+  string line(cols + 1, '\n');
+  for(int w = 0; w < numWorkers; w++) {
+    runCommand(GATHER, w);
+    for(int r = firstRow(w); r < firstRow(w + 1); r++) {
+      for(int c = 0; c < cols; c++)
+        line[c] = T(staging[(r - firstRow(w)) * cols + c]).name();
+      out.write(line.data(), line.size());
+    }
+  }
+  out << '\n';
+}
+
+/**
+ * Get the number of alive cells on the board
+ * @return int the population after the last simulate().
+ */
+template <typename T>
+int ShardLife<T>::getPopulation() const {
+  return population;
 }
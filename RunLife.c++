@@ -62,6 +62,7 @@ int main () {
     assert(file.good());
 
     Life<ConwayCell> l(file);
+    l.setCycleDetection(true);
 
     file.close();
 
@@ -106,11 +107,9 @@ int main () {
 
     l.print(cout);
 
-    l.simulate(1);
-    l.print(cout);
-
-    l.simulate(1);
-    l.print(cout);
+    l.startSnapshots(cout, 1);
+    l.simulate(2);
+    l.stopSnapshots();
   }
   catch (const invalid_argument&) {
     assert(false);
@@ -142,10 +141,9 @@ int main () {
 
     l.print(cout);
 
-    for(int x = 0; x < 5; x++) {
-      l.simulate(1);
-      l.print(cout);
-    }
+    l.startSnapshots(cout, 1);
+    l.simulate(5);
+    l.stopSnapshots();
     
   }
   catch (const invalid_argument&) {
@@ -14,10 +14,16 @@
 // includes
 // --------
 
+#include <cstdio>   // remove
+#include <cstdlib>  // rand, srand
+#include <fstream>  // ifstream, ofstream
 #include <iostream> // cout, endl
+#include <map>      // map
+#include <set>      // set
 #include <sstream>  // istringtstream, ostringstream
 #include <string>   // ==
 #include <stdexcept> // invalid_argument, out_of_range
+#include <utility>  // pair
 
 #include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
 #include "cppunit/TestFixture.h"             // TestFixture
@@ -132,11 +138,11 @@ struct TestLife : CppUnit::TestFixture {
   void test_Life_takeTurn_conway(){
     istringstream in("1\n1\n.\n");
     Life<ConwayCell> l(in);
-    CPPUNIT_ASSERT_EQUAL(false, l.grid[0][0].alive);
+    CPPUNIT_ASSERT_EQUAL(false, l.at(0, 0).alive);
     CPPUNIT_ASSERT_EQUAL(0, l.population);
     CPPUNIT_ASSERT_EQUAL(0, l.generation);
     l.takeTurn();
-    CPPUNIT_ASSERT_EQUAL(false, l.grid[0][0].alive);
+    CPPUNIT_ASSERT_EQUAL(false, l.at(0, 0).alive);
     CPPUNIT_ASSERT_EQUAL(0, l.population);
     CPPUNIT_ASSERT_EQUAL(1, l.generation);
   }
@@ -144,11 +150,11 @@ struct TestLife : CppUnit::TestFixture {
   void test_Life_takeTurn_fredkin(){
     istringstream in("1\n1\n-\n");
     Life<FredkinCell> l(in);
-    CPPUNIT_ASSERT_EQUAL(false, l.grid[0][0].alive);
+    CPPUNIT_ASSERT_EQUAL(false, l.at(0, 0).alive);
     CPPUNIT_ASSERT_EQUAL(0, l.population);
     CPPUNIT_ASSERT_EQUAL(0, l.generation);
     l.takeTurn();
-    CPPUNIT_ASSERT_EQUAL(false, l.grid[0][0].alive);
+    CPPUNIT_ASSERT_EQUAL(false, l.at(0, 0).alive);
     CPPUNIT_ASSERT_EQUAL(0, l.population);
     CPPUNIT_ASSERT_EQUAL(1, l.generation);
   }
@@ -156,27 +162,41 @@ struct TestLife : CppUnit::TestFixture {
   void test_Life_takeTurn_fredkin_9to10(){
     istringstream in("1\n2\n90\n");
     Life<FredkinCell> l(in);
-    CPPUNIT_ASSERT_EQUAL(true, l.grid[0][0].alive);
-    CPPUNIT_ASSERT_EQUAL(true, l.grid[0][1].alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.at(0, 0).alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.at(0, 1).alive);
     CPPUNIT_ASSERT_EQUAL(2, l.population);
     CPPUNIT_ASSERT_EQUAL(0, l.generation);
-    CPPUNIT_ASSERT_EQUAL('9', l.grid[0][0].name());
-    CPPUNIT_ASSERT_EQUAL(9, l.grid[0][0].age);
+    CPPUNIT_ASSERT_EQUAL('9', l.at(0, 0).name());
+    CPPUNIT_ASSERT_EQUAL(9, l.at(0, 0).age);
     l.takeTurn();
-    CPPUNIT_ASSERT_EQUAL(true, l.grid[0][0].alive);
-    CPPUNIT_ASSERT_EQUAL(true, l.grid[0][1].alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.at(0, 0).alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.at(0, 1).alive);
     CPPUNIT_ASSERT_EQUAL(2, l.population);
     CPPUNIT_ASSERT_EQUAL(1, l.generation);
-    CPPUNIT_ASSERT_EQUAL('+', l.grid[0][0].name());
-    CPPUNIT_ASSERT_EQUAL(10, l.grid[0][0].age);
+    CPPUNIT_ASSERT_EQUAL('+', l.at(0, 0).name());
+    CPPUNIT_ASSERT_EQUAL(10, l.at(0, 0).age);
+  }
+
+  void test_Life_takeTurn_double_buffer(){
+    istringstream in("1\n3\n***\n");
+    Life<ConwayCell> l(in);
+    l.takeTurn();
+    CPPUNIT_ASSERT_EQUAL(15, (int)l.grid.size());
+    CPPUNIT_ASSERT_EQUAL(15, (int)l.next.size());
+    CPPUNIT_ASSERT_EQUAL(false, l.at(0, 0).alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.at(0, 1).alive);
+    CPPUNIT_ASSERT_EQUAL(false, l.at(0, 2).alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.next[l.index(0, 0)].alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.next[l.index(0, 2)].alive);
+    CPPUNIT_ASSERT_EQUAL(1, l.population);
   }
 
   void test_life_constructor_1x1_dead() {
     istringstream in("1\n1\n.\n");
     Life<ConwayCell> l(in);
-    CPPUNIT_ASSERT_EQUAL(1, (int)l.grid.size());
-    CPPUNIT_ASSERT_EQUAL(1, (int)l.grid[0].size());
-    CPPUNIT_ASSERT_EQUAL(false, l.grid[0][0].alive);
+    CPPUNIT_ASSERT_EQUAL(1, l.rows);
+    CPPUNIT_ASSERT_EQUAL(1, l.cols);
+    CPPUNIT_ASSERT_EQUAL(false, l.at(0, 0).alive);
     CPPUNIT_ASSERT_EQUAL(0, l.population);
     CPPUNIT_ASSERT_EQUAL(0, l.generation);
   }
@@ -184,12 +204,12 @@ struct TestLife : CppUnit::TestFixture {
   void test_life_constructor_2x2_alive() {
     istringstream in("2\n2\n**\n**\n");
     Life<ConwayCell> l(in);
-    CPPUNIT_ASSERT_EQUAL(2, (int)l.grid.size());
-    CPPUNIT_ASSERT_EQUAL(2, (int)l.grid[0].size());
-    CPPUNIT_ASSERT_EQUAL(true, l.grid[0][0].alive);
-    CPPUNIT_ASSERT_EQUAL(true, l.grid[0][1].alive);
-    CPPUNIT_ASSERT_EQUAL(true, l.grid[1][0].alive);
-    CPPUNIT_ASSERT_EQUAL(true, l.grid[1][1].alive);
+    CPPUNIT_ASSERT_EQUAL(2, l.rows);
+    CPPUNIT_ASSERT_EQUAL(2, l.cols);
+    CPPUNIT_ASSERT_EQUAL(true, l.at(0, 0).alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.at(0, 1).alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.at(1, 0).alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.at(1, 1).alive);
     CPPUNIT_ASSERT_EQUAL(4, l.population);
     CPPUNIT_ASSERT_EQUAL(0, l.generation);
   }
@@ -197,10 +217,10 @@ struct TestLife : CppUnit::TestFixture {
   void test_life_constructor_1x1_fredkin() {
     istringstream in("1\n1\n-\n");
     Life<FredkinCell> l(in);
-    CPPUNIT_ASSERT_EQUAL(1, (int)l.grid.size());
-    CPPUNIT_ASSERT_EQUAL(1, (int)l.grid[0].size());
-    CPPUNIT_ASSERT_EQUAL(false, l.grid[0][0].alive);
-    CPPUNIT_ASSERT_EQUAL(0, l.grid[0][0].age);
+    CPPUNIT_ASSERT_EQUAL(1, l.rows);
+    CPPUNIT_ASSERT_EQUAL(1, l.cols);
+    CPPUNIT_ASSERT_EQUAL(false, l.at(0, 0).alive);
+    CPPUNIT_ASSERT_EQUAL(0, l.at(0, 0).age);
     CPPUNIT_ASSERT_EQUAL(0, l.population);
     CPPUNIT_ASSERT_EQUAL(0, l.generation);
   }
@@ -208,11 +228,11 @@ struct TestLife : CppUnit::TestFixture {
   void test_life_simulate_1x1() {
     istringstream in("1\n1\n*\n");
     Life<ConwayCell> l(in);
-    CPPUNIT_ASSERT_EQUAL(true, l.grid[0][0].alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.at(0, 0).alive);
     CPPUNIT_ASSERT_EQUAL(1, l.population);
     CPPUNIT_ASSERT_EQUAL(0, l.generation);
     l.simulate(500);
-    CPPUNIT_ASSERT_EQUAL(false, l.grid[0][0].alive);
+    CPPUNIT_ASSERT_EQUAL(false, l.at(0, 0).alive);
     CPPUNIT_ASSERT_EQUAL(0, l.population);
     CPPUNIT_ASSERT_EQUAL(500, l.generation);
   }
@@ -220,17 +240,17 @@ struct TestLife : CppUnit::TestFixture {
   void test_life_simulate_2x2() {
     istringstream in("2\n2\n**\n**\n");
     Life<ConwayCell> l(in);
-    CPPUNIT_ASSERT_EQUAL(true, l.grid[0][0].alive);
-    CPPUNIT_ASSERT_EQUAL(true, l.grid[0][1].alive);
-    CPPUNIT_ASSERT_EQUAL(true, l.grid[1][0].alive);
-    CPPUNIT_ASSERT_EQUAL(true, l.grid[1][1].alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.at(0, 0).alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.at(0, 1).alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.at(1, 0).alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.at(1, 1).alive);
     CPPUNIT_ASSERT_EQUAL(4, l.population);
     CPPUNIT_ASSERT_EQUAL(0, l.generation);
     l.simulate(500);
-    CPPUNIT_ASSERT_EQUAL(true, l.grid[0][0].alive);
-    CPPUNIT_ASSERT_EQUAL(true, l.grid[0][1].alive);
-    CPPUNIT_ASSERT_EQUAL(true, l.grid[1][0].alive);
-    CPPUNIT_ASSERT_EQUAL(true, l.grid[1][1].alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.at(0, 0).alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.at(0, 1).alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.at(1, 0).alive);
+    CPPUNIT_ASSERT_EQUAL(true, l.at(1, 1).alive);
     CPPUNIT_ASSERT_EQUAL(4, l.population);
     CPPUNIT_ASSERT_EQUAL(500, l.generation);
   }
@@ -242,17 +262,128 @@ struct TestLife : CppUnit::TestFixture {
     const bool expected2[3][3] = {{false, false, false}, {true, true, true}, {false, false, false}};
     for (int r = 0; r < 3; r++)
       for (int c = 0; c < 3; c++)
-        CPPUNIT_ASSERT_EQUAL(expected1[r][c], l.grid[r][c].alive);
+        CPPUNIT_ASSERT_EQUAL(expected1[r][c], l.at(r, c).alive);
     CPPUNIT_ASSERT_EQUAL(3, l.population);
     CPPUNIT_ASSERT_EQUAL(0, l.generation);
     l.simulate(333);
     for (int r = 0; r < 3; r++)
       for (int c = 0; c < 3; c++)
-        CPPUNIT_ASSERT_EQUAL(expected2[r][c], l.grid[r][c].alive);
+        CPPUNIT_ASSERT_EQUAL(expected2[r][c], l.at(r, c).alive);
     CPPUNIT_ASSERT_EQUAL(3, l.population);
     CPPUNIT_ASSERT_EQUAL(333, l.generation);
   }
 
+  void test_life_setThreads_exception() {
+    istringstream in("1\n1\n.\n");
+    Life<ConwayCell> l(in);
+    l.setThreads(0);
+  }
+
+  void test_life_simulate_threads_conway() {
+    ifstream file1("RunLifeConway.in");
+    ifstream file2("RunLifeConway.in");
+    Life<ConwayCell> expected(file1);
+    Life<ConwayCell> l(file2);
+    l.setThreads(4);
+    for (int x = 0; x < 3; x++) {
+      expected.simulate(41);
+      l.simulate(41);
+      ostringstream out1;
+      ostringstream out2;
+      expected.print(out1);
+      l.print(out2);
+      CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+    }
+  }
+
+  void test_life_simulate_threads_cell() {
+    string board = "9\n7\n";
+    const char cells[] = {'.', '*', '-', '0', '1'};
+    for (int r = 0; r < 9; r++) {
+      for (int c = 0; c < 7; c++)
+        board += cells[(r * 7 + c * 3) % 5];
+      board += "\n";
+    }
+    istringstream in1(board);
+    istringstream in2(board);
+    Life<Cell> expected(in1);
+    Life<Cell> l(in2);
+    l.setThreads(3);
+    l.simulate(2);
+    l.setThreads(16);
+    l.simulate(3);
+    expected.simulate(5);
+    ostringstream out1;
+    ostringstream out2;
+    expected.print(out1);
+    l.print(out2);
+    CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+    CPPUNIT_ASSERT_EQUAL(5, l.generation);
+  }
+
+  void test_life_simulate_incremental_conway() {
+    ifstream file1("RunLifeConway.in");
+    ifstream file2("RunLifeConway.in");
+    Life<ConwayCell> expected(file1);
+    Life<ConwayCell> l(file2);
+    l.setIncremental(true);
+    for (int x = 0; x < 3; x++) {
+      expected.simulate(97);
+      l.simulate(97);
+      ostringstream out1;
+      ostringstream out2;
+      expected.print(out1);
+      l.print(out2);
+      CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+    }
+  }
+
+  void test_life_simulate_incremental_fredkin() {
+    ifstream file1("RunLifeFredkin.in");
+    ifstream file2("RunLifeFredkin.in");
+    Life<FredkinCell> expected(file1);
+    Life<FredkinCell> l(file2);
+    l.setIncremental(true);
+    for (int x = 0; x < 12; x++) {
+      expected.simulate(1);
+      l.simulate(1);
+      ostringstream out1;
+      ostringstream out2;
+      expected.print(out1);
+      l.print(out2);
+      CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+      for (int i = 0; i < (int)l.grid.size(); i++)
+        CPPUNIT_ASSERT_EQUAL(expected.grid[i].age, l.grid[i].age);
+    }
+  }
+
+  void test_life_simulate_incremental_cell() {
+    ifstream file1("RunLife.in");
+    ifstream file2("RunLife.in");
+    Life<Cell> expected(file1);
+    Life<Cell> l(file2);
+    l.setIncremental(true);
+    expected.simulate(8);
+    l.simulate(8);
+    ostringstream out1;
+    ostringstream out2;
+    expected.print(out1);
+    l.print(out2);
+    CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+  }
+
+  void test_life_simulate_incremental_still() {
+    istringstream in("4\n4\n....\n.**.\n.**.\n....\n");
+    Life<ConwayCell> l(in);
+    l.setIncremental(true);
+    CPPUNIT_ASSERT_EQUAL(16, (int)l.active.size());
+    l.simulate(1);
+    CPPUNIT_ASSERT_EQUAL(0, (int)l.active.size());
+    l.simulate(10);
+    CPPUNIT_ASSERT_EQUAL(4, l.population);
+    CPPUNIT_ASSERT_EQUAL(11, l.generation);
+  }
+
   void test_Life_print_1x1() {
     istringstream in("1\n1\n.\n");
     Life<ConwayCell> l(in);
@@ -284,23 +415,22 @@ struct TestLife : CppUnit::TestFixture {
     
     int expected[3][3] = {{1, 2, 1}, {2, 2, 2}, {1, 2, 1}};
     
+    int counts[3][3];
     for (int x = 0; x < 3; x++) {
       for (int y = 0; y < 3; y++) {
-        l.current.r = x;
-        l.current.c = y;
-        l.countNeighbors(l.grid[x][y]);
+        counts[x][y] = l.countNeighbors(x, y);
       }
     }
     
-    CPPUNIT_ASSERT_EQUAL(expected[0][0], l.grid[0][0].numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[0][1], l.grid[0][1].numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[0][2], l.grid[0][2].numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[1][0], l.grid[1][0].numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[1][1], l.grid[1][1].numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[1][2], l.grid[1][2].numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[2][0], l.grid[2][0].numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[2][1], l.grid[2][1].numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[2][2], l.grid[2][2].numNeighbors);
+    CPPUNIT_ASSERT_EQUAL(expected[0][0], counts[0][0]);
+    CPPUNIT_ASSERT_EQUAL(expected[0][1], counts[0][1]);
+    CPPUNIT_ASSERT_EQUAL(expected[0][2], counts[0][2]);
+    CPPUNIT_ASSERT_EQUAL(expected[1][0], counts[1][0]);
+    CPPUNIT_ASSERT_EQUAL(expected[1][1], counts[1][1]);
+    CPPUNIT_ASSERT_EQUAL(expected[1][2], counts[1][2]);
+    CPPUNIT_ASSERT_EQUAL(expected[2][0], counts[2][0]);
+    CPPUNIT_ASSERT_EQUAL(expected[2][1], counts[2][1]);
+    CPPUNIT_ASSERT_EQUAL(expected[2][2], counts[2][2]);
   }
 
   void test_Life_countNeighbors_fredkin() {
@@ -308,23 +438,22 @@ struct TestLife : CppUnit::TestFixture {
     Life<FredkinCell> l(in);
     
     int expected[3][3] = {{0, 2, 0}, {2, 0, 2}, {0, 2, 0}};
+    int counts[3][3];
     for (int x = 0; x < 3; x++) {
       for (int y = 0; y < 3; y++) {
-        l.current.r = x;
-        l.current.c = y;
-        l.countNeighbors(l.grid[x][y]);
+        counts[x][y] = l.countNeighbors(x, y);
       }
     }
     
-    CPPUNIT_ASSERT_EQUAL(expected[0][0], l.grid[0][0].numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[0][1], l.grid[0][1].numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[0][2], l.grid[0][2].numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[1][0], l.grid[1][0].numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[1][1], l.grid[1][1].numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[1][2], l.grid[1][2].numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[2][0], l.grid[2][0].numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[2][1], l.grid[2][1].numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[2][2], l.grid[2][2].numNeighbors);
+    CPPUNIT_ASSERT_EQUAL(expected[0][0], counts[0][0]);
+    CPPUNIT_ASSERT_EQUAL(expected[0][1], counts[0][1]);
+    CPPUNIT_ASSERT_EQUAL(expected[0][2], counts[0][2]);
+    CPPUNIT_ASSERT_EQUAL(expected[1][0], counts[1][0]);
+    CPPUNIT_ASSERT_EQUAL(expected[1][1], counts[1][1]);
+    CPPUNIT_ASSERT_EQUAL(expected[1][2], counts[1][2]);
+    CPPUNIT_ASSERT_EQUAL(expected[2][0], counts[2][0]);
+    CPPUNIT_ASSERT_EQUAL(expected[2][1], counts[2][1]);
+    CPPUNIT_ASSERT_EQUAL(expected[2][2], counts[2][2]);
   }
 
   void test_Life_countNeighbors_cell() {
@@ -332,23 +461,22 @@ struct TestLife : CppUnit::TestFixture {
     Life<Cell> l(in);
     
     int expected[3][3] = {{1, 2, 1}, {2, 0, 2}, {1, 2, 1}};
+    int counts[3][3];
     for (int x = 0; x < 3; x++) {
       for (int y = 0; y < 3; y++) {
-        l.current.r = x;
-        l.current.c = y;
-        l.countNeighbors(l.grid[x][y]);
+        counts[x][y] = l.countNeighbors(x, y);
       }
     }
     
-    CPPUNIT_ASSERT_EQUAL(expected[0][0], l.grid[0][0].ptr->numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[0][1], l.grid[0][1].ptr->numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[0][2], l.grid[0][2].ptr->numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[1][0], l.grid[1][0].ptr->numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[1][1], l.grid[1][1].ptr->numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[1][2], l.grid[1][2].ptr->numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[2][0], l.grid[2][0].ptr->numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[2][1], l.grid[2][1].ptr->numNeighbors);
-    CPPUNIT_ASSERT_EQUAL(expected[2][2], l.grid[2][2].ptr->numNeighbors);
+    CPPUNIT_ASSERT_EQUAL(expected[0][0], counts[0][0]);
+    CPPUNIT_ASSERT_EQUAL(expected[0][1], counts[0][1]);
+    CPPUNIT_ASSERT_EQUAL(expected[0][2], counts[0][2]);
+    CPPUNIT_ASSERT_EQUAL(expected[1][0], counts[1][0]);
+    CPPUNIT_ASSERT_EQUAL(expected[1][1], counts[1][1]);
+    CPPUNIT_ASSERT_EQUAL(expected[1][2], counts[1][2]);
+    CPPUNIT_ASSERT_EQUAL(expected[2][0], counts[2][0]);
+    CPPUNIT_ASSERT_EQUAL(expected[2][1], counts[2][1]);
+    CPPUNIT_ASSERT_EQUAL(expected[2][2], counts[2][2]);
   }
 
   
@@ -358,9 +486,7 @@ struct TestLife : CppUnit::TestFixture {
     bool expected[3][3] = {{false, false, false}, {true, false, false}, {false, true, false}};
     for (int x = 0; x < 3; x++) {
       for (int y = 0; y < 3; y++) {
-        l.current.r = x;
-        l.current.c = y;
-        CPPUNIT_ASSERT_EQUAL(expected[x][y], l.isAlive(NORTH)); 
+        CPPUNIT_ASSERT_EQUAL(expected[x][y], l.isAlive(Position(x, y) + NORTH));
       }
     }
   }
@@ -371,9 +497,7 @@ struct TestLife : CppUnit::TestFixture {
     bool expected[3][3] = {{false, false, false}, {false, false, false}, {true, false, false}};
     for (int x = 0; x < 3; x++) {
       for (int y = 0; y < 3; y++) {
-        l.current.r = x;
-        l.current.c = y;
-        CPPUNIT_ASSERT_EQUAL(expected[x][y], l.isAlive(NORTH_EAST)); 
+        CPPUNIT_ASSERT_EQUAL(expected[x][y], l.isAlive(Position(x, y) + NORTH_EAST));
       }
     }
   }
@@ -384,9 +508,7 @@ struct TestLife : CppUnit::TestFixture {
     bool expected[3][3] = {{false, false, false}, {true, false, false}, {false, true, false}};
     for (int x = 0; x < 3; x++) {
       for (int y = 0; y < 3; y++) {
-        l.current.r = x;
-        l.current.c = y;
-        CPPUNIT_ASSERT_EQUAL(expected[x][y], l.isAlive(EAST)); 
+        CPPUNIT_ASSERT_EQUAL(expected[x][y], l.isAlive(Position(x, y) + EAST));
       }
     }
   }
@@ -397,9 +519,7 @@ struct TestLife : CppUnit::TestFixture {
     bool expected[3][3] = {{true, false, false}, {false, true, false}, {false, false, false}};
     for (int x = 0; x < 3; x++) {
       for (int y = 0; y < 3; y++) {
-        l.current.r = x;
-        l.current.c = y;
-        CPPUNIT_ASSERT_EQUAL(expected[x][y], l.isAlive(SOUTH_EAST)); 
+        CPPUNIT_ASSERT_EQUAL(expected[x][y], l.isAlive(Position(x, y) + SOUTH_EAST));
       }
     }
   }
@@ -410,9 +530,7 @@ struct TestLife : CppUnit::TestFixture {
     bool expected[3][3] = {{false, true, false}, {false, false, true}, {false, false, false}};
     for (int x = 0; x < 3; x++) {
       for (int y = 0; y < 3; y++) {
-        l.current.r = x;
-        l.current.c = y;
-        CPPUNIT_ASSERT_EQUAL(expected[x][y], l.isAlive(SOUTH)); 
+        CPPUNIT_ASSERT_EQUAL(expected[x][y], l.isAlive(Position(x, y) + SOUTH));
       }
     }
   }
@@ -423,9 +541,7 @@ struct TestLife : CppUnit::TestFixture {
     bool expected[3][3] = {{false, false, true}, {false, false, false}, {false, false, false}};
     for (int x = 0; x < 3; x++) {
       for (int y = 0; y < 3; y++) {
-        l.current.r = x;
-        l.current.c = y;
-        CPPUNIT_ASSERT_EQUAL(expected[x][y], l.isAlive(SOUTH_WEST)); 
+        CPPUNIT_ASSERT_EQUAL(expected[x][y], l.isAlive(Position(x, y) + SOUTH_WEST));
       }
     }
   }
@@ -436,9 +552,7 @@ struct TestLife : CppUnit::TestFixture {
     bool expected[3][3] = {{false, true, false}, {false, false, true}, {false, false, false}};
     for (int x = 0; x < 3; x++) {
       for (int y = 0; y < 3; y++) {
-        l.current.r = x;
-        l.current.c = y;
-        CPPUNIT_ASSERT_EQUAL(expected[x][y], l.isAlive(WEST)); 
+        CPPUNIT_ASSERT_EQUAL(expected[x][y], l.isAlive(Position(x, y) + WEST));
       }
     }
   }
@@ -449,9 +563,7 @@ struct TestLife : CppUnit::TestFixture {
     bool expected[3][3] = {{false, false, false}, {false, true, false}, {false, false, true}};
     for (int x = 0; x < 3; x++) {
       for (int y = 0; y < 3; y++) {
-        l.current.r = x;
-        l.current.c = y;
-        CPPUNIT_ASSERT_EQUAL(expected[x][y], l.isAlive(NORTH_WEST)); 
+        CPPUNIT_ASSERT_EQUAL(expected[x][y], l.isAlive(Position(x, y) + NORTH_WEST));
       }
     }
   }
@@ -490,23 +602,6 @@ struct TestLife : CppUnit::TestFixture {
     myCell.age = 14;
     CPPUNIT_ASSERT_EQUAL(14, (int)myCell);
   }
-  
-  void test_AbstractCell_setNeighbors_exception(){
-    ConwayCell myCell('*');
-    myCell.setNeighbors(666);
-  }
-
-  void test_AbstractCell_setNeighbors_conway(){
-    ConwayCell myCell('*');
-    myCell.setNeighbors(3);
-    CPPUNIT_ASSERT_EQUAL(3, myCell.numNeighbors);
-  }
-  
-  void test_AbstractCell_setNeighbors_fredkin(){
-    FredkinCell myCell('0');
-    myCell.setNeighbors(3);
-    CPPUNIT_ASSERT_EQUAL(3, myCell.numNeighbors);
-  }
 
   // ----
   // Cell
@@ -517,84 +612,87 @@ struct TestLife : CppUnit::TestFixture {
   void test_Cell_copyConstructor_dead() {
     Cell c('.');
     Cell d(c);
-    CPPUNIT_ASSERT_EQUAL(false, d.ptr->alive);
+    CPPUNIT_ASSERT_EQUAL(false, d.alive);
     CPPUNIT_ASSERT_EQUAL('.', d.name());
-    CPPUNIT_ASSERT(c.ptr != d.ptr);
+    CPPUNIT_ASSERT_EQUAL(c.kind, d.kind);
   }
   
   void test_Cell_copyConstructor_alive() {
     Cell c('*');
     Cell d(c);
-    CPPUNIT_ASSERT_EQUAL(true, d.ptr->alive);
+    CPPUNIT_ASSERT_EQUAL(true, d.alive);
     CPPUNIT_ASSERT_EQUAL('*', d.name());
-    CPPUNIT_ASSERT(c.ptr != d.ptr);
+    CPPUNIT_ASSERT_EQUAL(c.kind, d.kind);
   }
   
   void test_Cell_copyConstructor_fredkin() {
     Cell c('0');
     Cell d(c);
-    CPPUNIT_ASSERT_EQUAL(true, d.ptr->alive);
+    CPPUNIT_ASSERT_EQUAL(true, d.alive);
     CPPUNIT_ASSERT_EQUAL('0', d.name());
-    CPPUNIT_ASSERT(c.ptr != d.ptr);
+    CPPUNIT_ASSERT_EQUAL(c.kind, d.kind);
   }
 
   // copy assignment
   void test_Cell_copyAssignment_conway() {
     Cell c('.');
     Cell d('*');
-    CPPUNIT_ASSERT_EQUAL(true, d.ptr->alive);
+    CPPUNIT_ASSERT_EQUAL(true, d.alive);
     CPPUNIT_ASSERT_EQUAL('*', d.name());
-    CPPUNIT_ASSERT(c.ptr != d.ptr);
     d = c;
-    CPPUNIT_ASSERT_EQUAL(false, d.ptr->alive);
+    CPPUNIT_ASSERT_EQUAL(false, d.alive);
     CPPUNIT_ASSERT_EQUAL('.', d.name());
-    CPPUNIT_ASSERT(c.ptr != d.ptr);
+    CPPUNIT_ASSERT_EQUAL(c.kind, d.kind);
   }
   
   void test_Cell_copyAssignment_fredkin() {
     Cell c('-');
     Cell d('0');
-    CPPUNIT_ASSERT_EQUAL(true, d.ptr->alive);
+    CPPUNIT_ASSERT_EQUAL(true, d.alive);
     CPPUNIT_ASSERT_EQUAL('0', d.name());
-    CPPUNIT_ASSERT(c.ptr != d.ptr);
     d = c;
-    CPPUNIT_ASSERT_EQUAL(false, d.ptr->alive);
+    CPPUNIT_ASSERT_EQUAL(false, d.alive);
     CPPUNIT_ASSERT_EQUAL('-', d.name());
-    CPPUNIT_ASSERT(c.ptr != d.ptr);
+    CPPUNIT_ASSERT_EQUAL(c.kind, d.kind);
   }
   
   void test_Cell_copyAssignment_ftoc() {
     Cell c('*');
     Cell d('-');
-    CPPUNIT_ASSERT_EQUAL(false, d.ptr->alive);
+    CPPUNIT_ASSERT_EQUAL(false, d.alive);
     CPPUNIT_ASSERT_EQUAL('-', d.name());
-    CPPUNIT_ASSERT(c.ptr != d.ptr);
     d = c;
-    CPPUNIT_ASSERT_EQUAL(true, d.ptr->alive);
+    CPPUNIT_ASSERT_EQUAL(true, d.alive);
     CPPUNIT_ASSERT_EQUAL('*', d.name());
-    CPPUNIT_ASSERT(c.ptr != d.ptr);
+    CPPUNIT_ASSERT_EQUAL(c.kind, d.kind);
   }
 
   // turn
   void test_Cell_turn_conway(){
     Cell myCell('*');
-    myCell.ptr->numNeighbors = 4;
-    myCell.turn();
-    CPPUNIT_ASSERT_EQUAL(false, myCell.ptr->alive);
+    myCell.turn(4);
+    CPPUNIT_ASSERT_EQUAL(false, myCell.alive);
   }
   void test_Cell_turn_fredkin(){
     Cell myCell('0');
-    myCell.ptr->numNeighbors = 4;
-    myCell.turn();
-    CPPUNIT_ASSERT_EQUAL(false, myCell.ptr->alive);
+    myCell.turn(4);
+    CPPUNIT_ASSERT_EQUAL(false, myCell.alive);
   }
   void test_Cell_turn_ftoc(){
     Cell myCell('0');
-    myCell.ptr->numNeighbors = 3;
-    dynamic_cast<FredkinCell*>(myCell.ptr)->age = 1;
-    myCell.turn();
-    CPPUNIT_ASSERT_EQUAL(true, myCell.ptr->alive);
+    myCell.age = 1;
+    myCell.turn(3);
+    CPPUNIT_ASSERT_EQUAL(true, myCell.alive);
     CPPUNIT_ASSERT_EQUAL('*', myCell.name());
+    CPPUNIT_ASSERT_EQUAL(Cell::CONWAY, myCell.kind);
+    CPPUNIT_ASSERT_EQUAL(0, (int)myCell);
+  }
+  void test_Cell_turn_fredkin_age1(){
+    Cell myCell('0');
+    myCell.turn(1);
+    CPPUNIT_ASSERT_EQUAL(true, myCell.alive);
+    CPPUNIT_ASSERT_EQUAL('1', myCell.name());
+    CPPUNIT_ASSERT_EQUAL(Cell::FREDKIN, myCell.kind);
   }
   // neighbors
   
@@ -626,26 +724,6 @@ struct TestLife : CppUnit::TestFixture {
     Cell myCell('-');
     CPPUNIT_ASSERT_EQUAL('-', myCell.name());
   }
-
-  // setNeighbors
-
-  void test_Cell_setNeighbors_conway(){
-    Cell myCell('*');
-    myCell.setNeighbors(4);
-    CPPUNIT_ASSERT_EQUAL(4, myCell.ptr->numNeighbors);
-  }
-  
-  void test_Cell_setNeighbors_fredkin(){
-    Cell myCell('*');
-    myCell.setNeighbors(4);
-    CPPUNIT_ASSERT_EQUAL(4, myCell.ptr->numNeighbors);
-  }
-
-  void test_Cell_setNeighbors_fredkin_dead(){
-    Cell myCell('-');
-    myCell.setNeighbors(4);
-    CPPUNIT_ASSERT_EQUAL(4, myCell.ptr->numNeighbors);
-  }
   
   // operator bool
   
@@ -686,27 +764,23 @@ struct TestLife : CppUnit::TestFixture {
   
   void test_ConwayCell_turn_dtod(){
     ConwayCell myCell('.');
-    myCell.numNeighbors = 2;
-    myCell.turn();
+    myCell.turn(2);
     CPPUNIT_ASSERT_EQUAL(false, myCell.alive);
   }
   void test_ConwayCell_turn_dtoa(){
     ConwayCell myCell('.');
-    myCell.numNeighbors = 3;
-    myCell.turn();
+    myCell.turn(3);
     CPPUNIT_ASSERT_EQUAL(true, myCell.alive);
   }
   void test_ConwayCell_turn_atoa(){
     ConwayCell myCell('*');
-    myCell.numNeighbors = 2;
-    myCell.turn();
+    myCell.turn(2);
     CPPUNIT_ASSERT_EQUAL(true, myCell.alive);
   }
   
   void test_ConwayCell_turn_atod(){
     ConwayCell myCell('*');
-    myCell.numNeighbors = 4;
-    myCell.turn();
+    myCell.turn(4);
     CPPUNIT_ASSERT_EQUAL(false, myCell.alive);
   }
   
@@ -774,30 +848,26 @@ struct TestLife : CppUnit::TestFixture {
   
   void test_FredkinCell_turn_dtod(){
     FredkinCell myCell('-');
-    myCell.numNeighbors = 2;
-    myCell.turn();
+    myCell.turn(2);
     CPPUNIT_ASSERT_EQUAL(false, myCell.alive);
     CPPUNIT_ASSERT_EQUAL(0, myCell.age);
   }
   void test_FredkinCell_turn_dtoa(){
     FredkinCell myCell('-');
-    myCell.numNeighbors = 3;
-    myCell.turn();
+    myCell.turn(3);
     CPPUNIT_ASSERT_EQUAL(true, myCell.alive);
     CPPUNIT_ASSERT_EQUAL(0, myCell.age);
   }
   void test_FredkinCell_turn_atoa(){
     FredkinCell myCell('2');
-    myCell.numNeighbors = 3;
-    myCell.turn();
+    myCell.turn(3);
     CPPUNIT_ASSERT_EQUAL(true, myCell.alive);
     CPPUNIT_ASSERT_EQUAL(3, myCell.age);
   }
   
   void test_FredkinCell_turn_atod(){
     FredkinCell myCell('2');
-    myCell.numNeighbors = 4;
-    myCell.turn();
+    myCell.turn(4);
     CPPUNIT_ASSERT_EQUAL(false, myCell.alive);
     CPPUNIT_ASSERT_EQUAL(2, myCell.age);
   }
@@ -820,6 +890,14 @@ struct TestLife : CppUnit::TestFixture {
     CPPUNIT_ASSERT_EQUAL('+', myCell.name());
   }
   
+  void test_FredkinCell_equal_age(){
+    FredkinCell myCell('3');
+    FredkinCell other('3');
+    CPPUNIT_ASSERT(myCell == other);
+    other.age = 4;
+    CPPUNIT_ASSERT(!(myCell == other));
+  }
+  
   void test_FredkinCell_clone_dead(){
     FredkinCell myCellPrime('-');
     FredkinCell* myCellClone = dynamic_cast<FredkinCell*>(myCellPrime.clone());
@@ -848,6 +926,1018 @@ struct TestLife : CppUnit::TestFixture {
     delete myCellClone;
   }
   
+  // -------
+  // BitLife
+  // -------
+
+  void test_BitLife_constructor_2x2() {
+    istringstream in("2\n2\n*.\n.*\n");
+    BitLife l(in);
+    CPPUNIT_ASSERT_EQUAL(2, l.rows);
+    CPPUNIT_ASSERT_EQUAL(2, l.cols);
+    CPPUNIT_ASSERT_EQUAL(1, l.wordsPerRow);
+    CPPUNIT_ASSERT_EQUAL(true, l.isAlive(0, 0));
+    CPPUNIT_ASSERT_EQUAL(false, l.isAlive(0, 1));
+    CPPUNIT_ASSERT_EQUAL(false, l.isAlive(1, 0));
+    CPPUNIT_ASSERT_EQUAL(true, l.isAlive(1, 1));
+    CPPUNIT_ASSERT_EQUAL(2, l.population);
+    CPPUNIT_ASSERT_EQUAL(0, l.generation);
+  }
+
+  void test_BitLife_simulate_flipper() {
+    istringstream in("3\n3\n.*.\n.*.\n.*.\n");
+    BitLife l(in);
+    l.simulate(333);
+    ostringstream out;
+    l.print(out);
+    CPPUNIT_ASSERT_EQUAL((string)"Generation = 333, Population = 3.\n...\n***\n...\n\n", out.str());
+  }
+
+  void test_BitLife_simulate_word_boundary() {
+    string board = "7\n130\n";
+    for (int r = 0; r < 7; r++) {
+      string row(130, '.');
+      if (r >= 1 && r <= 3) {
+        row[63] = '*';
+        row[64] = '*';
+        row[129] = '*';
+      }
+      if (r == 5) {
+        row[0] = '*';
+        row[1] = '*';
+        row[2] = '*';
+        row[127] = '*';
+        row[128] = '*';
+      }
+      board += row + "\n";
+    }
+    istringstream in1(board);
+    istringstream in2(board);
+    Life<ConwayCell> expected(in1);
+    BitLife l(in2);
+    for (int x = 0; x < 6; x++) {
+      ostringstream out1;
+      ostringstream out2;
+      expected.print(out1);
+      l.print(out2);
+      CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+      expected.simulate(1);
+      l.simulate(1);
+    }
+  }
+
+  void test_BitLife_RunLifeConway() {
+    ifstream file("RunLifeConway.in");
+    CPPUNIT_ASSERT(file.good());
+    BitLife l(file);
+    ifstream oracle("RunLifeConway.out");
+    CPPUNIT_ASSERT(oracle.good());
+    string header;
+    getline(oracle, header);
+    ostringstream expected;
+    expected << oracle.rdbuf();
+    ostringstream out;
+    l.print(out);
+    l.simulate(283);
+    l.print(out);
+    l.simulate(40);
+    l.print(out);
+    l.simulate(2500);
+    l.print(out);
+    CPPUNIT_ASSERT_EQUAL(expected.str(), out.str().substr(0, expected.str().size()));
+  }
+
+  // --------
+  // HashLife
+  // --------
+
+  void test_HashLife_constructor_2x3() {
+    istringstream in("2\n3\n*..\n.**\n");
+    HashLife l(in);
+    CPPUNIT_ASSERT_EQUAL(2, l.rows);
+    CPPUNIT_ASSERT_EQUAL(3, l.cols);
+    CPPUNIT_ASSERT_EQUAL(2, l.root->level);
+    CPPUNIT_ASSERT_EQUAL(true, l.isAlive(0, 0));
+    CPPUNIT_ASSERT_EQUAL(false, l.isAlive(0, 1));
+    CPPUNIT_ASSERT_EQUAL(true, l.isAlive(1, 2));
+    CPPUNIT_ASSERT_EQUAL(false, l.isAlive(2, 2));
+    CPPUNIT_ASSERT_EQUAL(3, l.population);
+  }
+
+  void test_HashLife_simulate_glider_wall() {
+    string board = "8\n8\n.*......\n..*.....\n***.....\n";
+    for (int r = 3; r < 8; r++)
+      board += "........\n";
+    istringstream in1(board);
+    istringstream in2(board);
+    Life<ConwayCell> expected(in1);
+    HashLife l(in2);
+    for (int x = 0; x < 8; x++) {
+      expected.simulate(x * 3);
+      l.simulate(x * 3);
+      ostringstream out1;
+      ostringstream out2;
+      expected.print(out1);
+      l.print(out2);
+      CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+    }
+  }
+
+  void test_HashLife_collect() {
+    ifstream file1("RunLifeConway.in");
+    ifstream file2("RunLifeConway.in");
+    BitLife expected(file1);
+    HashLife l(file2, 100);
+    expected.simulate(777);
+    l.simulate(777);
+    CPPUNIT_ASSERT(l.nodes() < 2000);
+    ostringstream out1;
+    ostringstream out2;
+    expected.print(out1);
+    l.print(out2);
+    CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+  }
+
+  void test_HashLife_collect_peak() {
+    srand(1);
+    ostringstream board;
+    board << 200 << endl << 200 << endl;
+    for(int r = 0; r < 200; r++) {
+      for(int c = 0; c < 200; c++)
+        board << (rand() % 3 ? '.' : '*');
+      board << endl;
+    }
+    istringstream in1(board.str());
+    istringstream in2(board.str());
+    HashLife expected(in1);
+    HashLife l(in2, 50000);
+    expected.simulate(1024);
+    l.simulate(1024);
+    CPPUNIT_ASSERT(expected.peakNodes() > 200000);
+    CPPUNIT_ASSERT(l.peakNodes() <= 50000 + 16);
+    ostringstream out1;
+    ostringstream out2;
+    expected.print(out1);
+    l.print(out2);
+    CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+  }
+
+  void test_HashLife_RunLifeConway() {
+    ifstream file("RunLifeConway.in");
+    CPPUNIT_ASSERT(file.good());
+    HashLife l(file);
+    ifstream oracle("RunLifeConway.out");
+    CPPUNIT_ASSERT(oracle.good());
+    string header;
+    getline(oracle, header);
+    ostringstream expected;
+    expected << oracle.rdbuf();
+    ostringstream out;
+    l.print(out);
+    l.simulate(283);
+    l.print(out);
+    l.simulate(40);
+    l.print(out);
+    l.simulate(2500);
+    l.print(out);
+    CPPUNIT_ASSERT_EQUAL(expected.str(), out.str().substr(0, expected.str().size()));
+  }
+
+  // ----------
+  // SparseLife
+  // ----------
+
+  void test_SparseLife_constructor() {
+    istringstream in("2\n3\n*..\n.**\n");
+    SparseLife l(in);
+    CPPUNIT_ASSERT_EQUAL(2, l.rows);
+    CPPUNIT_ASSERT_EQUAL(3, l.cols);
+    CPPUNIT_ASSERT_EQUAL(1, l.tileCount());
+    CPPUNIT_ASSERT_EQUAL(true, l.isAlive(0, 0));
+    CPPUNIT_ASSERT_EQUAL(true, l.isAlive(1, 2));
+    CPPUNIT_ASSERT_EQUAL(false, l.isAlive(-1, -1));
+    CPPUNIT_ASSERT_EQUAL(3, l.population);
+  }
+
+  void test_SparseLife_simulate_glider() {
+    istringstream in("3\n3\n.*.\n..*\n***\n");
+    SparseLife l(in);
+    l.simulate(400);
+    CPPUNIT_ASSERT_EQUAL(5, l.population);
+    CPPUNIT_ASSERT(l.tileCount() <= 4);
+    ostringstream out;
+    l.print(out, 100, 100, 3, 3);
+    CPPUNIT_ASSERT_EQUAL((string)"Generation = 400, Population = 5.\n.*.\n..*\n***\n\n", out.str());
+  }
+
+  void test_SparseLife_simulate_glider_negative() {
+    istringstream in("3\n3\n***\n*..\n.*.\n");
+    SparseLife l(in);
+    l.simulate(400);
+    CPPUNIT_ASSERT_EQUAL(5, l.population);
+    CPPUNIT_ASSERT(l.tileCount() <= 4);
+    CPPUNIT_ASSERT_EQUAL(true, l.find(-2, -2) != 0);
+    ostringstream out;
+    l.print(out, -100, -100, 3, 3);
+    CPPUNIT_ASSERT_EQUAL((string)"Generation = 400, Population = 5.\n***\n*..\n.*.\n\n", out.str());
+  }
+
+  void test_SparseLife_simulate_bitlife() {
+    ifstream file("RunLifeConway.in");
+    int rows;
+    int cols;
+    file >> rows >> cols;
+    ostringstream board;
+    board << rows + 200 << endl << cols + 200 << endl;
+    for (int r = 0; r < rows + 200; r++) {
+      string line(cols + 200, '.');
+      if (r >= 100 && r < rows + 100) {
+        string row;
+        file >> row;
+        line.replace(100, cols, row);
+      }
+      board << line << endl;
+    }
+    istringstream in1(board.str());
+    istringstream in2(board.str());
+    BitLife expected(in1);
+    SparseLife l(in2);
+    for (int x = 0; x < 4; x++) {
+      expected.simulate(25);
+      l.simulate(25);
+      ostringstream out1;
+      ostringstream out2;
+      expected.print(out1);
+      l.print(out2);
+      CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+    }
+  }
+
+  // -----------
+  // FredkinLife
+  // -----------
+
+  void test_FredkinLife_constructor() {
+    istringstream in("2\n3\n-8-\n--0\n");
+    FredkinLife l(in);
+    CPPUNIT_ASSERT_EQUAL(2, l.rows);
+    CPPUNIT_ASSERT_EQUAL(3, l.cols);
+    CPPUNIT_ASSERT_EQUAL(32, l.stride);
+    CPPUNIT_ASSERT_EQUAL(true, l.isAlive(0, 1));
+    CPPUNIT_ASSERT_EQUAL(8, l.getAge(0, 1));
+    CPPUNIT_ASSERT_EQUAL(false, l.isAlive(1, 1));
+    CPPUNIT_ASSERT_EQUAL(2, l.population);
+  }
+
+  void test_FredkinLife_simulate_kernels() {
+    string board = "11\n77\n";
+    for (int r = 0; r < 11; r++) {
+      for (int c = 0; c < 77; c++)
+        board += ((r * 5 + c * 3) % 7 < 2) ? (char) ('0' + (r + c) % 10) : '-';
+      board += "\n";
+    }
+    const FredkinLife::Kernel kernels[] = {FredkinLife::SCALAR, FredkinLife::SSE2, FredkinLife::AVX2};
+    for (int k = 0; k < 3; k++) {
+      if (!FredkinLife::supported(kernels[k]))
+        continue;
+      istringstream in1(board);
+      istringstream in2(board);
+      Life<FredkinCell> expected(in1);
+      FredkinLife l(in2);
+      l.setKernel(kernels[k]);
+      for (int x = 0; x < 6; x++) {
+        expected.simulate(x);
+        l.simulate(x);
+        ostringstream out1;
+        ostringstream out2;
+        expected.print(out1);
+        l.print(out2);
+        CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+      }
+    }
+  }
+
+  void test_FredkinLife_simulate_saturate() {
+    istringstream in("1\n2\n90\n");
+    FredkinLife l(in);
+    l.setKernel(FredkinLife::SCALAR);
+    l.simulate(300);
+    CPPUNIT_ASSERT_EQUAL(255, l.getAge(0, 0));
+    CPPUNIT_ASSERT_EQUAL(255, l.getAge(0, 1));
+    ostringstream out;
+    l.print(out);
+    CPPUNIT_ASSERT_EQUAL((string)"Generation = 300, Population = 2.\n++\n\n", out.str());
+  }
+
+  void test_FredkinLife_RunLifeFredkin() {
+    ifstream file("RunLifeFredkin.in");
+    CPPUNIT_ASSERT(file.good());
+    FredkinLife l(file);
+    ifstream oracle("RunLifeFredkin.out");
+    CPPUNIT_ASSERT(oracle.good());
+    string header;
+    getline(oracle, header);
+    ostringstream expected;
+    expected << oracle.rdbuf();
+    ostringstream out;
+    l.print(out);
+    l.simulate(1);
+    l.print(out);
+    l.simulate(1);
+    l.print(out);
+    CPPUNIT_ASSERT_EQUAL(expected.str(), out.str().substr(0, expected.str().size()));
+  }
+
+  // -------
+  // Pattern
+  // -------
+
+  void test_Pattern_native() {
+    const string text = "2\n3\n-8-\n--0\n";
+    Pattern p(text.data(), text.size());
+    CPPUNIT_ASSERT_EQUAL(Pattern::NATIVE, p.format);
+    CPPUNIT_ASSERT_EQUAL(2, p.rows);
+    CPPUNIT_ASSERT_EQUAL(3, p.cols);
+    CPPUNIT_ASSERT_EQUAL((string)"-8---0", string(p.cells.begin(), p.cells.end()));
+  }
+
+  void test_Pattern_plaintext() {
+    const string text = "!Name: Glider\r\n.O\r\n..O\r\nOOO\r\n";
+    Pattern p(text.data(), text.size());
+    CPPUNIT_ASSERT_EQUAL(Pattern::PLAINTEXT, p.format);
+    CPPUNIT_ASSERT_EQUAL(3, p.rows);
+    CPPUNIT_ASSERT_EQUAL(3, p.cols);
+    CPPUNIT_ASSERT_EQUAL((string)".*...****", string(p.cells.begin(), p.cells.end()));
+  }
+
+  void test_Pattern_rle() {
+    const string text = "#N Glider\nx = 3, y = 4, rule = B3/S23\nbo$2bo$\n3o!\n";
+    Pattern p(text.data(), text.size());
+    CPPUNIT_ASSERT_EQUAL(Pattern::RLE, p.format);
+    CPPUNIT_ASSERT_EQUAL(4, p.rows);
+    CPPUNIT_ASSERT_EQUAL(3, p.cols);
+    CPPUNIT_ASSERT_EQUAL((string)".*...****...", string(p.cells.begin(), p.cells.end()));
+  }
+
+  void test_Pattern_rle_exception() {
+    const string text = "x = 2, y = 1\n3o!\n";
+    Pattern p(text.data(), text.size());
+  }
+
+  void test_Life_file_constructor() {
+    ifstream file("RunLifeConway.in");
+    Life<ConwayCell> expected(file);
+    Life<ConwayCell> l("RunLifeConway.in");
+    expected.simulate(50);
+    l.simulate(50);
+    ostringstream out1;
+    ostringstream out2;
+    expected.print(out1);
+    l.print(out2);
+    CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+  }
+
+  void test_Life_file_constructor_rle_fredkin() {
+    {
+      ofstream file("TestLife.tmp");
+      file << "x = 3, y = 2\n2o$bo!\n";
+    }
+    Life<FredkinCell> l("TestLife.tmp");
+    remove("TestLife.tmp");
+    ostringstream out;
+    l.print(out);
+    CPPUNIT_ASSERT_EQUAL((string)"Generation = 0, Population = 3.\n00-\n-0-\n\n", out.str());
+  }
+
+  void test_Life_printDelta_keyframe() {
+    istringstream in("1\n7\n00000-3\n");
+    Life<FredkinCell> l(in);
+    ostringstream out;
+    l.printDelta(out);
+    CPPUNIT_ASSERT_EQUAL((string)"Generation = 0, Population = 6, Changes = 7.\n0 0 [5]0-3\n\n", out.str());
+  }
+
+  void test_Life_printDelta_flipper() {
+    istringstream in("3\n3\n.*.\n.*.\n.*.\n");
+    Life<ConwayCell> l(in);
+    ostringstream out1;
+    ostringstream out2;
+    l.printDelta(out1);
+    l.simulate(1);
+    l.printDelta(out2);
+    CPPUNIT_ASSERT_EQUAL((string)"Generation = 0, Population = 3, Changes = 9.\n0 0 .*.\n1 0 .*.\n2 0 .*.\n\n", out1.str());
+    CPPUNIT_ASSERT_EQUAL((string)"Generation = 1, Population = 3, Changes = 4.\n0 1 .\n1 0 *\n1 2 *\n2 1 .\n\n", out2.str());
+  }
+
+  void test_Life_printDelta_unchanged() {
+    istringstream in("2\n2\n**\n**\n");
+    Life<ConwayCell> l(in);
+    ostringstream out;
+    l.printDelta(out);
+    l.simulate(5);
+    out.str("");
+    l.printDelta(out);
+    CPPUNIT_ASSERT_EQUAL((string)"Generation = 5, Population = 4, Changes = 0.\n\n", out.str());
+  }
+
+  void test_Life_checkpoint_fredkin_age() {
+    istringstream in("1\n3\n0-0\n");
+    Life<FredkinCell> l(in);
+    l.at(0, 0).age = 42;
+    l.checkpoint("TestLife.ckpt");
+    Life<FredkinCell> restored("TestLife.ckpt");
+    remove("TestLife.ckpt");
+    CPPUNIT_ASSERT_EQUAL(1, restored.rows);
+    CPPUNIT_ASSERT_EQUAL(3, restored.cols);
+    CPPUNIT_ASSERT_EQUAL(2, restored.population);
+    CPPUNIT_ASSERT_EQUAL(42, restored.at(0, 0).age);
+    CPPUNIT_ASSERT(restored.at(0, 0) == l.at(0, 0));
+    CPPUNIT_ASSERT(!restored.at(0, 1).alive);
+  }
+
+  void test_Life_checkpoint_resume() {
+    ifstream file("RunLife.in");
+    Life<Cell> expected(file);
+    Life<Cell> l("RunLife.in");
+    l.simulate(7);
+    l.checkpoint("TestLife.ckpt");
+    Life<Cell> restored("TestLife.ckpt");
+    remove("TestLife.ckpt");
+    expected.simulate(20);
+    restored.simulate(13);
+    ostringstream out1;
+    ostringstream out2;
+    expected.print(out1);
+    restored.print(out2);
+    CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+    CPPUNIT_ASSERT_EQUAL(20, restored.generation);
+  }
+
+  void test_Life_checkpoint_truncated() {
+    istringstream in("2\n2\n**\n**\n");
+    Life<ConwayCell> l(in);
+    l.checkpoint("TestLife.ckpt");
+    truncate("TestLife.ckpt", sizeof(CheckpointHeader) + 4);
+    try {
+      Life<ConwayCell> restored("TestLife.ckpt");
+      CPPUNIT_ASSERT(false);
+    }
+    catch(invalid_argument& e) {
+    }
+    remove("TestLife.ckpt");
+  }
+
+  void test_Life_checkpoint_cell_type() {
+    istringstream in("1\n2\n0-\n");
+    Life<FredkinCell> l(in);
+    l.checkpoint("TestLife.ckpt");
+    try {
+      Life<ConwayCell> restored("TestLife.ckpt");
+      CPPUNIT_ASSERT(false);
+    }
+    catch(invalid_argument& e) {
+    }
+    Life<FredkinCell> restored("TestLife.ckpt");
+    remove("TestLife.ckpt");
+    CPPUNIT_ASSERT_EQUAL(1, restored.population);
+  }
+
+  void test_Life_checkpoint_corrupt() {
+    istringstream in("1\n2\n**\n");
+    Life<ConwayCell> l(in);
+    l.checkpoint("TestLife.ckpt");
+    CheckpointHeader header;
+    {
+      fstream file("TestLife.ckpt", ios::in | ios::out | ios::binary);
+      file.read((char*) &header, sizeof(header));
+      file.seekp(sizeof(header));
+      file.put(7);
+    }
+    try {
+      Life<ConwayCell> restored("TestLife.ckpt");
+      CPPUNIT_ASSERT(false);
+    }
+    catch(invalid_argument& e) {
+    }
+    header.rows = 1 << 30;
+    header.cols = 1 << 30;
+    {
+      fstream file("TestLife.ckpt", ios::in | ios::out | ios::binary);
+      file.write((const char*) &header, sizeof(header));
+    }
+    try {
+      Life<ConwayCell> restored("TestLife.ckpt");
+      CPPUNIT_ASSERT(false);
+    }
+    catch(invalid_argument& e) {
+    }
+    remove("TestLife.ckpt");
+  }
+
+  void test_Life_cycle_flipper() {
+    istringstream in("3\n3\n.*.\n.*.\n.*.\n");
+    Life<ConwayCell> l(in);
+    l.setCycleDetection(true);
+    l.simulate(1001);
+    CPPUNIT_ASSERT_EQUAL(2, l.getPeriod());
+    CPPUNIT_ASSERT_EQUAL(0, l.getTransient());
+    CPPUNIT_ASSERT_EQUAL(1001, l.generation);
+    CPPUNIT_ASSERT(l.at(1, 0).alive);
+    CPPUNIT_ASSERT(!l.at(0, 1).alive);
+  }
+
+  void test_Life_cycle_RunLifeConway() {
+    ifstream file1("RunLifeConway.in");
+    ifstream file2("RunLifeConway.in");
+    Life<ConwayCell> expected(file1);
+    Life<ConwayCell> l(file2);
+    l.setCycleDetection(true);
+    expected.simulate(2823);
+    l.simulate(2823);
+    ostringstream out1;
+    ostringstream out2;
+    expected.print(out1);
+    l.print(out2);
+    CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+    CPPUNIT_ASSERT(l.getPeriod() > 0);
+    CPPUNIT_ASSERT(l.getTransient() > 0);
+  }
+
+  void test_Life_cycle_fredkin_ages() {
+    istringstream in("1\n2\n00\n");
+    Life<FredkinCell> l(in);
+    l.setCycleDetection(true);
+    l.simulate(50);
+    CPPUNIT_ASSERT_EQUAL(0, l.getPeriod());
+    CPPUNIT_ASSERT_EQUAL(50, l.at(0, 1).age);
+    l.at(0, 1).alive = false;
+    l.setCycleDetection(true);
+    l.simulate(50);
+    CPPUNIT_ASSERT_EQUAL(2, l.getPeriod());
+    CPPUNIT_ASSERT_EQUAL(100, l.generation);
+  }
+
+  void test_Life_cycle_transient() {
+    istringstream in("6\n6\n......\n......\n..**..\n..*...\n......\n......\n");
+    Life<ConwayCell> l(in);
+    l.setThreads(2);
+    l.setCycleDetection(true);
+    l.simulate(5);
+    CPPUNIT_ASSERT_EQUAL(1, l.getPeriod());
+    CPPUNIT_ASSERT(!l.startGrid.empty());
+    CPPUNIT_ASSERT_EQUAL(1, l.getTransient());
+    CPPUNIT_ASSERT(l.startGrid.empty());
+    CPPUNIT_ASSERT_EQUAL(5, l.generation);
+    CPPUNIT_ASSERT_EQUAL(4, l.population);
+  }
+
+  void test_Life_cycle_transient_incremental() {
+    ifstream file("RunLifeConway.in");
+    Life<ConwayCell> l(file);
+    l.setIncremental(true);
+    l.setCycleDetection(true);
+    l.simulate(2500);
+    CPPUNIT_ASSERT_EQUAL(2, l.getPeriod());
+    CPPUNIT_ASSERT_EQUAL(323, l.getTransient());
+  }
+
+#ifdef LIFE_STATS
+  static void countStats(const GenerationStats& stats, void* context) {
+    *(int*) context += stats.births;
+  }
+
+  void test_Life_stats_flipper() {
+    istringstream in("3\n3\n.*.\n.*.\n.*.\n");
+    Life<ConwayCell> l(in);
+    l.simulate(3);
+    vector<GenerationStats> stats;
+    CPPUNIT_ASSERT_EQUAL(3, l.drainStats(stats));
+    CPPUNIT_ASSERT_EQUAL(0, l.drainStats(stats));
+    CPPUNIT_ASSERT_EQUAL(3, (int) stats.size());
+    CPPUNIT_ASSERT_EQUAL(1, stats[0].generation);
+    CPPUNIT_ASSERT_EQUAL(3, stats[2].population);
+    CPPUNIT_ASSERT_EQUAL(2, stats[1].births);
+    CPPUNIT_ASSERT_EQUAL(2, stats[1].deaths);
+    CPPUNIT_ASSERT(stats[0].countSeconds >= 0);
+  }
+
+  void test_Life_stats_promotions() {
+    istringstream in("1\n2\n00\n");
+    Life<Cell> l(in);
+    l.setIncremental(true);
+    l.simulate(2);
+    vector<GenerationStats> stats;
+    l.drainStats(stats);
+    CPPUNIT_ASSERT_EQUAL(0, stats[0].promotions);
+    CPPUNIT_ASSERT_EQUAL(2, stats[1].promotions);
+    CPPUNIT_ASSERT_EQUAL(0, stats[1].births);
+    CPPUNIT_ASSERT_EQUAL(0, stats[1].deaths);
+  }
+
+  void test_Life_stats_callback() {
+    istringstream in("3\n3\n.*.\n.*.\n.*.\n");
+    Life<ConwayCell> l(in);
+    int births = 0;
+    l.setStatsCallback(countStats, &births);
+    l.setThreads(2);
+    l.simulate(10);
+    CPPUNIT_ASSERT_EQUAL(20, births);
+  }
+
+  void test_Life_stats_dropped() {
+    istringstream in("2\n2\n**\n**\n");
+    Life<ConwayCell> l(in);
+    l.simulate(LIFE_STATS_RING + 5);
+    vector<GenerationStats> stats;
+    CPPUNIT_ASSERT_EQUAL(LIFE_STATS_RING, l.drainStats(stats));
+    CPPUNIT_ASSERT_EQUAL(5u, l.droppedStats());
+    l.simulate(1);
+    l.drainStats(stats);
+    CPPUNIT_ASSERT_EQUAL(LIFE_STATS_RING + 6, stats.back().generation);
+  }
+#endif
+
+  void test_RuleLife_conway_bitlife() {
+    ifstream file1("RunLifeConway.in");
+    ifstream file2("RunLifeConway.in");
+    BitLife expected(file1);
+    RuleLife<ConwayRule, Moore> l(file2);
+    expected.simulate(323);
+    l.simulate(323);
+    ostringstream out1;
+    ostringstream out2;
+    expected.print(out1);
+    l.print(out2);
+    CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+  }
+
+  void test_RuleLife_fredkin() {
+    ifstream file1("RunLifeFredkin.in");
+    ifstream file2("RunLifeFredkin.in");
+    Life<FredkinCell> expected(file1);
+    RuleLife<FredkinRule, VonNeumann> l(file2);
+    expected.simulate(5);
+    l.simulate(5);
+    CPPUNIT_ASSERT_EQUAL(expected.population, l.population);
+    for(int r = 0; r < l.rows; r++)
+      for(int c = 0; c < l.cols; c++)
+        CPPUNIT_ASSERT_EQUAL(expected.at(r, c).alive, l.isAlive(r, c));
+  }
+
+  void test_RuleLife_seeds() {
+    istringstream in("3\n4\n....\n.**.\n....\n");
+    RuleLife<SeedsRule, Moore> l(in);
+    l.simulate(1);
+    ostringstream out;
+    l.print(out);
+    CPPUNIT_ASSERT_EQUAL((string)"Generation = 1, Population = 4.\n.**.\n....\n.**.\n\n", out.str());
+  }
+
+  void test_RuleLife_highlife_custom() {
+    istringstream in1("3\n3\n***\n*.*\n*..\n");
+    istringstream in2("3\n3\n***\n*.*\n*..\n");
+    RuleLife<HighLifeRule, Moore> highLife(in1);
+    RuleLife<ConwayRule, Moore> conway(in2);
+    highLife.simulate(1);
+    conway.simulate(1);
+    CPPUNIT_ASSERT(highLife.isAlive(1, 1));
+    CPPUNIT_ASSERT(!conway.isAlive(1, 1));
+    
+    typedef Offset<-2, 0, Offset<2, 0> > Far;
+    CPPUNIT_ASSERT_EQUAL(2, (int) Far::radius);
+    istringstream in3("5\n1\n.\n.\n*\n.\n.\n");
+    RuleLife<Rule<1 << 1, 0>, Far> l(in3);
+    l.simulate(1);
+    CPPUNIT_ASSERT_EQUAL(2, l.population);
+    CPPUNIT_ASSERT(l.isAlive(0, 0));
+    CPPUNIT_ASSERT(l.isAlive(4, 0));
+  }
+
+  void test_Life_toroidal_glider() {
+    istringstream in("8\n8\n.*......\n..*.....\n***.....\n........\n........\n........\n........\n........\n");
+    Life<ConwayCell> l(in);
+    l.setBoundary(Life<ConwayCell>::TOROIDAL);
+    ostringstream out1;
+    ostringstream out2;
+    l.print(out1);
+    l.simulate(32);
+    l.print(out2);
+    CPPUNIT_ASSERT_EQUAL(5, l.population);
+    CPPUNIT_ASSERT_EQUAL(out1.str().substr(out1.str().find('\n')), out2.str().substr(out2.str().find('\n')));
+  }
+
+  void test_Life_toroidal_edges() {
+    istringstream in("3\n5\n....*\n....*\n....*\n");
+    Life<ConwayCell> l(in);
+    l.setBoundary(Life<ConwayCell>::TOROIDAL);
+    CPPUNIT_ASSERT(l.isAlive(Position(0, -1)));
+    CPPUNIT_ASSERT(l.isAlive(Position(-1, 4)));
+    CPPUNIT_ASSERT_EQUAL(3, l.countNeighbors(1, 0));
+    l.simulate(1);
+    CPPUNIT_ASSERT_EQUAL(9, l.population);
+    CPPUNIT_ASSERT(l.at(1, 0).alive);
+    CPPUNIT_ASSERT(l.at(1, 3).alive);
+  }
+
+  void test_Life_toroidal_paths() {
+    istringstream file1("8\n8\n.*......\n..*.....\n***.....\n........\n........\n........\n........\n........\n");
+    istringstream file2(file1.str());
+    istringstream file3(file1.str());
+    Life<ConwayCell> serial(file1);
+    Life<ConwayCell> threaded(file2);
+    Life<ConwayCell> incremental(file3);
+    serial.setBoundary(Life<ConwayCell>::TOROIDAL);
+    threaded.setBoundary(Life<ConwayCell>::TOROIDAL);
+    incremental.setBoundary(Life<ConwayCell>::TOROIDAL);
+    threaded.setThreads(3);
+    incremental.setIncremental(true);
+    serial.simulate(30);
+    threaded.simulate(30);
+    incremental.simulate(30);
+    ostringstream out1;
+    ostringstream out2;
+    ostringstream out3;
+    serial.print(out1);
+    threaded.print(out2);
+    incremental.print(out3);
+    CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+    CPPUNIT_ASSERT_EQUAL(out1.str(), out3.str());
+  }
+
+  void test_Life_toroidal_off() {
+    istringstream in("6\n6\n*....*\n......\n......\n......\n......\n*....*\n");
+    Life<ConwayCell> l(in);
+    l.setBoundary(Life<ConwayCell>::TOROIDAL);
+    l.simulate(1);
+    l.setBoundary(Life<ConwayCell>::DEAD);
+    ostringstream cells;
+    cells << "6\n6\n";
+    for(int r = 0; r < 6; r++) {
+      for(int c = 0; c < 6; c++)
+        cells << (l.at(r, c).alive ? '*' : '.');
+      cells << '\n';
+    }
+    istringstream file(cells.str());
+    Life<ConwayCell> dead(file);
+    l.simulate(2);
+    dead.simulate(2);
+    ostringstream out1;
+    ostringstream out2;
+    l.print(out1);
+    dead.print(out2);
+    CPPUNIT_ASSERT_EQUAL(0, l.population);
+    CPPUNIT_ASSERT_EQUAL(out1.str().substr(out1.str().find('\n')), out2.str().substr(out2.str().find('\n')));
+  }
+
+  void test_Life_toroidal_checkpoint() {
+    istringstream in("3\n5\n....*\n....*\n....*\n");
+    Life<ConwayCell> l(in);
+    l.setBoundary(Life<ConwayCell>::TOROIDAL);
+    l.checkpoint("TestLife.ckpt");
+    Life<ConwayCell> restored("TestLife.ckpt");
+    remove("TestLife.ckpt");
+    CPPUNIT_ASSERT(restored.boundary == Life<ConwayCell>::TOROIDAL);
+    l.simulate(1);
+    restored.simulate(1);
+    CPPUNIT_ASSERT_EQUAL(9, restored.population);
+    CPPUNIT_ASSERT(restored.at(1, 0).alive);
+  }
+
+  void test_BatchLife_add() {
+    BatchLife batch;
+    istringstream in1("1\n3\n*.*\n");
+    istringstream in2("2\n2\n..\n.*\n");
+    CPPUNIT_ASSERT_EQUAL(0, batch.add(in1));
+    CPPUNIT_ASSERT_EQUAL(1, batch.add(in2));
+    CPPUNIT_ASSERT_EQUAL(2, batch.size());
+    CPPUNIT_ASSERT_EQUAL(2, (int) batch.slices.size());
+    CPPUNIT_ASSERT_EQUAL(2, batch.getPopulation(0));
+    CPPUNIT_ASSERT(batch.isAlive(0, 0, 2));
+    CPPUNIT_ASSERT(!batch.isAlive(1, 0, 1));
+    CPPUNIT_ASSERT(batch.isAlive(1, 1, 1));
+  }
+
+  void test_BatchLife_add_fredkin() {
+    BatchLife batch;
+    istringstream in1("1\n3\n*.*\n");
+    istringstream in2("1\n3\n0-0\n");
+    batch.add(in1);
+    try {
+      batch.add(in2);
+      CPPUNIT_ASSERT(false);
+    }
+    catch(invalid_argument& e) {
+    }
+    CPPUNIT_ASSERT_EQUAL(1, batch.size());
+    CPPUNIT_ASSERT_EQUAL(1, batch.slices[0].boards);
+  }
+
+  void test_BatchLife_add_size() {
+    BatchLife batch;
+    istringstream in1("0\n3\n");
+    istringstream in2("2\n-1\n");
+    try {
+      batch.add(in1);
+      CPPUNIT_ASSERT(false);
+    }
+    catch(invalid_argument& e) {
+    }
+    try {
+      batch.add(in2);
+      CPPUNIT_ASSERT(false);
+    }
+    catch(invalid_argument& e) {
+    }
+    CPPUNIT_ASSERT_EQUAL(0, batch.size());
+  }
+
+  void test_BatchLife_simulate_bitlife() {
+    BatchLife batch;
+    vector<string> text;
+    srand(1);
+    for(int b = 0; b < 150; b++) {
+      int size = b % 2 ? 20 : 33;
+      ostringstream board;
+      board << size << "\n" << size << "\n";
+      for(int r = 0; r < size; r++) {
+        for(int c = 0; c < size; c++)
+          board << (rand() % 3 ? '.' : '*');
+        board << "\n";
+      }
+      text.push_back(board.str());
+      istringstream in(text.back());
+      batch.add(in);
+    }
+    CPPUNIT_ASSERT_EQUAL(4, (int) batch.slices.size());
+    batch.setThreads(3);
+    batch.simulate(40);
+    for(int b = 0; b < 150; b++) {
+      istringstream in(text[b]);
+      BitLife expected(in);
+      expected.simulate(40);
+      ostringstream out1;
+      ostringstream out2;
+      expected.print(out1);
+      batch.print(b, out2);
+      CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+    }
+  }
+
+  void test_BatchLife_add_after_simulate() {
+    BatchLife batch;
+    istringstream in1("1\n3\n***\n");
+    istringstream in2("1\n3\n***\n");
+    batch.add(in1);
+    batch.simulate(1);
+    batch.add(in2);
+    CPPUNIT_ASSERT_EQUAL(2, (int) batch.slices.size());
+    ostringstream out1;
+    ostringstream out2;
+    batch.print(0, out1);
+    batch.print(1, out2);
+    CPPUNIT_ASSERT_EQUAL((string)"Generation = 1, Population = 1.\n.*.\n\n", out1.str());
+    CPPUNIT_ASSERT_EQUAL((string)"Generation = 0, Population = 3.\n***\n\n", out2.str());
+  }
+
+  void test_ShardLife_conway() {
+    ifstream file1("RunLifeConway.in");
+    ifstream file2("RunLifeConway.in");
+    Life<ConwayCell> expected(file1);
+    ShardLife<ConwayCell> l(file2, 4);
+    for(int i = 0; i < 3; i++) {
+      expected.simulate(100);
+      l.simulate(100);
+      ostringstream out1;
+      ostringstream out2;
+      expected.print(out1);
+      l.print(out2);
+      CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+    }
+  }
+
+  void test_ShardLife_fredkin() {
+    ifstream file1("RunLifeFredkin.in");
+    ifstream file2("RunLifeFredkin.in");
+    Life<FredkinCell> expected(file1);
+    ShardLife<FredkinCell> l(file2, 3);
+    expected.simulate(15);
+    l.simulate(15);
+    ostringstream out1;
+    ostringstream out2;
+    expected.print(out1);
+    l.print(out2);
+    CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+    CPPUNIT_ASSERT_EQUAL(expected.population, l.getPopulation());
+    for(int w = 0; w < 3; w++) {
+      l.runCommand(ShardLife<FredkinCell>::GATHER, w);
+      for(int r = l.firstRow(w); r < l.firstRow(w + 1); r++)
+        for(int c = 0; c < l.cols; c++)
+          CPPUNIT_ASSERT_EQUAL(expected.at(r, c).age, l.staging[(r - l.firstRow(w)) * l.cols + c].age);
+    }
+  }
+
+  void test_ShardLife_cell() {
+    ifstream file1("RunLife.in");
+    ifstream file2("RunLife.in");
+    Life<Cell> expected(file1);
+    ShardLife<Cell> l(file2, 20);
+    expected.simulate(9);
+    l.simulate(9);
+    ostringstream out1;
+    ostringstream out2;
+    expected.print(out1);
+    l.print(out2);
+    CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+  }
+
+  void test_ShardLife_workers() {
+    istringstream in("2\n2\n**\n**\n");
+    ShardLife<ConwayCell> l(in, 3);
+  }
+
+  void test_ShardLife_dead_worker() {
+    ifstream file("RunLifeConway.in");
+    ShardLife<ConwayCell> l(file, 3);
+    l.simulate(10);
+    kill(l.workers[1], SIGKILL);
+    try {
+      l.simulate(10);
+      CPPUNIT_ASSERT(false);
+    }
+    catch(runtime_error& e) {
+    }
+    CPPUNIT_ASSERT(l.workers.empty());
+    try {
+      ostringstream out;
+      l.print(out);
+      CPPUNIT_ASSERT(false);
+    }
+    catch(runtime_error& e) {
+    }
+  }
+
+  void test_Life_snapshots_full() {
+    ifstream file1("RunLifeConway.in");
+    ifstream file2("RunLifeConway.in");
+    Life<ConwayCell> expected(file1);
+    Life<ConwayCell> l(file2);
+    ostringstream out1;
+    ostringstream out2;
+    for(int i = 0; i < 3; i++) {
+      expected.simulate(10);
+      expected.print(out1);
+    }
+    l.startSnapshots(out2, 10);
+    l.simulate(35);
+    l.stopSnapshots();
+    CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+    CPPUNIT_ASSERT(l.snapshotOut == 0);
+  }
+
+  void test_Life_snapshots_delta() {
+    ifstream file1("RunLifeFredkin.in");
+    ifstream file2("RunLifeFredkin.in");
+    Life<FredkinCell> expected(file1);
+    Life<FredkinCell> l(file2);
+    ostringstream out1;
+    ostringstream out2;
+    for(int i = 0; i < 6; i++) {
+      expected.simulate(2);
+      expected.printDelta(out1);
+    }
+    l.startSnapshots(out2, 2, 1, Life<FredkinCell>::DELTA);
+    for(int i = 0; i < 4; i++)
+      l.simulate(3);
+    l.stopSnapshots();
+    CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+  }
+
+  void test_Life_snapshots_threads_cycles() {
+    ifstream file1("RunLifeConway.in");
+    ifstream file2("RunLifeConway.in");
+    Life<ConwayCell> expected(file1);
+    Life<ConwayCell> l(file2);
+    ostringstream out1;
+    ostringstream out2;
+    for(int i = 0; i < 8; i++) {
+      expected.simulate(400);
+      expected.print(out1);
+    }
+    l.setThreads(2);
+    l.setCycleDetection(true);
+    l.startSnapshots(out2, 400, 3);
+    l.simulate(3200);
+    l.stopSnapshots();
+    CPPUNIT_ASSERT_EQUAL(out1.str(), out2.str());
+  }
+
+  void test_Life_snapshots_every() {
+    istringstream in("1\n1\n*\n");
+    Life<ConwayCell> l(in);
+    ostringstream out;
+    l.startSnapshots(out, 0);
+  }
+
   
   // -----
   // suite
@@ -870,6 +1960,7 @@ struct TestLife : CppUnit::TestFixture {
   CPPUNIT_TEST(test_Life_takeTurn_conway);
   CPPUNIT_TEST(test_Life_takeTurn_fredkin);
   CPPUNIT_TEST(test_Life_takeTurn_fredkin_9to10);
+  CPPUNIT_TEST(test_Life_takeTurn_double_buffer);
   
   CPPUNIT_TEST(test_life_constructor_1x1_dead);
   CPPUNIT_TEST(test_life_constructor_2x2_alive);
@@ -878,6 +1969,13 @@ struct TestLife : CppUnit::TestFixture {
   CPPUNIT_TEST(test_life_simulate_1x1);
   CPPUNIT_TEST(test_life_simulate_2x2);
   CPPUNIT_TEST(test_life_simulate_flipper);
+  CPPUNIT_TEST_EXCEPTION(test_life_setThreads_exception, invalid_argument);
+  CPPUNIT_TEST(test_life_simulate_threads_conway);
+  CPPUNIT_TEST(test_life_simulate_threads_cell);
+  CPPUNIT_TEST(test_life_simulate_incremental_conway);
+  CPPUNIT_TEST(test_life_simulate_incremental_fredkin);
+  CPPUNIT_TEST(test_life_simulate_incremental_cell);
+  CPPUNIT_TEST(test_life_simulate_incremental_still);
   
   CPPUNIT_TEST(test_Life_print_1x1);
   CPPUNIT_TEST(test_Life_print_3x3);
@@ -904,9 +2002,6 @@ struct TestLife : CppUnit::TestFixture {
   CPPUNIT_TEST(test_AbstractCell_operator_int_fredkin_0);
   CPPUNIT_TEST(test_AbstractCell_operator_int_fredkin_14);
   
-  CPPUNIT_TEST_EXCEPTION(test_AbstractCell_setNeighbors_exception, invalid_argument);
-  CPPUNIT_TEST(test_AbstractCell_setNeighbors_conway);
-  CPPUNIT_TEST(test_AbstractCell_setNeighbors_fredkin);
   
   CPPUNIT_TEST(test_Cell_copyConstructor_dead);
   CPPUNIT_TEST(test_Cell_copyConstructor_alive);
@@ -919,6 +2014,7 @@ struct TestLife : CppUnit::TestFixture {
   CPPUNIT_TEST(test_Cell_turn_conway);
   CPPUNIT_TEST(test_Cell_turn_fredkin);
   CPPUNIT_TEST(test_Cell_turn_ftoc);
+  CPPUNIT_TEST(test_Cell_turn_fredkin_age1);
   
   CPPUNIT_TEST(test_Cell_neighbors_conway);
   CPPUNIT_TEST(test_Cell_neighbors_fredkin);
@@ -927,9 +2023,6 @@ struct TestLife : CppUnit::TestFixture {
   CPPUNIT_TEST(test_Cell_name_fredkin_3);
   CPPUNIT_TEST(test_Cell_name_fredkin_dead);
   
-  CPPUNIT_TEST(test_Cell_setNeighbors_conway);
-  CPPUNIT_TEST(test_Cell_setNeighbors_fredkin);
-  CPPUNIT_TEST(test_Cell_setNeighbors_fredkin_dead);
   
   CPPUNIT_TEST(test_Cell_operator_bool_dead);
   CPPUNIT_TEST(test_Cell_operator_bool_alive);
@@ -967,10 +2060,91 @@ struct TestLife : CppUnit::TestFixture {
   CPPUNIT_TEST(test_FredkinCell_name_dead);
   CPPUNIT_TEST(test_FredkinCell_name_age14);
   
+  CPPUNIT_TEST(test_FredkinCell_equal_age);
+  
   CPPUNIT_TEST(test_FredkinCell_clone_dead);
   CPPUNIT_TEST(test_FredkinCell_clone_alive_3);
   CPPUNIT_TEST(test_FredkinCell_clone_alive_14);
   
+  CPPUNIT_TEST(test_BitLife_constructor_2x2);
+  CPPUNIT_TEST(test_BitLife_simulate_flipper);
+  CPPUNIT_TEST(test_BitLife_simulate_word_boundary);
+  CPPUNIT_TEST(test_BitLife_RunLifeConway);
+  
+  CPPUNIT_TEST(test_HashLife_constructor_2x3);
+  CPPUNIT_TEST(test_HashLife_simulate_glider_wall);
+  CPPUNIT_TEST(test_HashLife_collect);
+  CPPUNIT_TEST(test_HashLife_collect_peak);
+  CPPUNIT_TEST(test_HashLife_RunLifeConway);
+  
+  CPPUNIT_TEST(test_SparseLife_constructor);
+  CPPUNIT_TEST(test_SparseLife_simulate_glider);
+  CPPUNIT_TEST(test_SparseLife_simulate_glider_negative);
+  CPPUNIT_TEST(test_SparseLife_simulate_bitlife);
+  
+  CPPUNIT_TEST(test_FredkinLife_constructor);
+  CPPUNIT_TEST(test_FredkinLife_simulate_kernels);
+  CPPUNIT_TEST(test_FredkinLife_simulate_saturate);
+  CPPUNIT_TEST(test_FredkinLife_RunLifeFredkin);
+  
+  CPPUNIT_TEST(test_Pattern_native);
+  CPPUNIT_TEST(test_Pattern_plaintext);
+  CPPUNIT_TEST(test_Pattern_rle);
+  CPPUNIT_TEST_EXCEPTION(test_Pattern_rle_exception, invalid_argument);
+  CPPUNIT_TEST(test_Life_file_constructor);
+  CPPUNIT_TEST(test_Life_file_constructor_rle_fredkin);
+  
+  CPPUNIT_TEST(test_Life_printDelta_keyframe);
+  CPPUNIT_TEST(test_Life_printDelta_flipper);
+  CPPUNIT_TEST(test_Life_printDelta_unchanged);
+  
+  CPPUNIT_TEST(test_Life_checkpoint_fredkin_age);
+  CPPUNIT_TEST(test_Life_checkpoint_resume);
+  CPPUNIT_TEST(test_Life_checkpoint_truncated);
+  CPPUNIT_TEST(test_Life_checkpoint_cell_type);
+  CPPUNIT_TEST(test_Life_checkpoint_corrupt);
+  
+  CPPUNIT_TEST(test_Life_cycle_flipper);
+  CPPUNIT_TEST(test_Life_cycle_RunLifeConway);
+  CPPUNIT_TEST(test_Life_cycle_fredkin_ages);
+  CPPUNIT_TEST(test_Life_cycle_transient);
+  CPPUNIT_TEST(test_Life_cycle_transient_incremental);
+  
+#ifdef LIFE_STATS
+  CPPUNIT_TEST(test_Life_stats_flipper);
+  CPPUNIT_TEST(test_Life_stats_promotions);
+  CPPUNIT_TEST(test_Life_stats_callback);
+  CPPUNIT_TEST(test_Life_stats_dropped);
+#endif
+  
+  CPPUNIT_TEST(test_RuleLife_conway_bitlife);
+  CPPUNIT_TEST(test_RuleLife_fredkin);
+  CPPUNIT_TEST(test_RuleLife_seeds);
+  CPPUNIT_TEST(test_RuleLife_highlife_custom);
+  
+  CPPUNIT_TEST(test_Life_toroidal_glider);
+  CPPUNIT_TEST(test_Life_toroidal_edges);
+  CPPUNIT_TEST(test_Life_toroidal_paths);
+  CPPUNIT_TEST(test_Life_toroidal_off);
+  CPPUNIT_TEST(test_Life_toroidal_checkpoint);
+  
+  CPPUNIT_TEST(test_BatchLife_add);
+  CPPUNIT_TEST(test_BatchLife_add_fredkin);
+  CPPUNIT_TEST(test_BatchLife_add_size);
+  CPPUNIT_TEST(test_BatchLife_simulate_bitlife);
+  CPPUNIT_TEST(test_BatchLife_add_after_simulate);
+  
+  CPPUNIT_TEST(test_ShardLife_conway);
+  CPPUNIT_TEST(test_ShardLife_fredkin);
+  CPPUNIT_TEST(test_ShardLife_cell);
+  CPPUNIT_TEST_EXCEPTION(test_ShardLife_workers, invalid_argument);
+  CPPUNIT_TEST(test_ShardLife_dead_worker);
+  
+  CPPUNIT_TEST(test_Life_snapshots_full);
+  CPPUNIT_TEST(test_Life_snapshots_delta);
+  CPPUNIT_TEST(test_Life_snapshots_threads_cycles);
+  CPPUNIT_TEST_EXCEPTION(test_Life_snapshots_every, invalid_argument);
+  
   CPPUNIT_TEST_SUITE_END();
 };
 